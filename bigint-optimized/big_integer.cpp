@@ -1,101 +1,1564 @@
 #include "big_integer.h"
+#include "limbs.h"
 
-#include <cstring>
+#include <algorithm>
+#include <cmath>
+#include <ostream>
 #include <stdexcept>
+#include <type_traits>
 
-big_integer::big_integer()
+static_assert(std::is_same<big_integer::limb_t, limbs::limb_t>::value, "storage and kernels must agree on limb type");
+
+namespace
+{
+typedef big_integer::limb_t limb_t;
+typedef big_integer::storage_t storage_t;
+
+// the largest power of ten that fits in a limb
+size_t const decimal_digits = 19;
+limb_t const decimal_base = 10000000000000000000ULL;
+
+limb_t pow10(size_t n)
+{
+    limb_t r = 1;
+    while (n-- != 0)
+        r *= 10;
+    return r;
+}
+
+// operand size (in limbs) below which conversion to and from decimal works 19 digits at a time
+size_t const decimal_basecase = 32;
+
+// powers[k] = 10^(19 2^k) for every k with 2 19 2^k <= digits, at least 10^19, and any
+// larger ones found before. The squarings dominate a conversion, so each thread keeps the
+// powers for the next and extends them when a longer number comes; they take about half as
+// much memory as the longest number converted.
+std::vector<storage_t> const& decimal_powers(size_t digits)
+{
+    thread_local std::vector<storage_t> powers(1, storage_t(1, decimal_base));
+    for (size_t width = decimal_digits << powers.size(); 2 * width <= digits; width *= 2)
+    {
+        storage_t const& p = powers.back();
+        storage_t sq(2 * p.size());
+        limbs::sqr(sq.data(), p.data(), p.size());
+        sq.resize(limbs::normalized_size(sq.data(), sq.size()));
+        powers.push_back(std::move(sq));
+    }
+    return powers;
+}
+
+// out[0, width) = x[0, n) in decimal with leading zeros, x < 10^width, x is destroyed.
+// x is split by the largest cached power of ten with at most half as many digits as out.
+void write_decimal(char* out, size_t width, limb_t* x, size_t n, std::vector<storage_t> const& powers)
+{
+    n = limbs::normalized_size(x, n);
+    if (n <= decimal_basecase)
+    {
+        char* end = out + width;
+        while (n != 0)
+        {
+            limb_t chunk = limbs::divrem_1(x, x, n, decimal_base);
+            n = limbs::normalized_size(x, n);
+            for (size_t j = 0; j != decimal_digits && end != out; ++j, chunk /= 10)
+                *--end = static_cast<char>('0' + chunk % 10);
+        }
+        std::fill(out, end, '0');
+        return;
+    }
+
+    size_t k = 0;
+    while (k + 1 != powers.size() && 2 * (decimal_digits << (k + 1)) <= width)
+        ++k;
+    size_t low_width = decimal_digits << k;
+    storage_t const& p = powers[k];
+    if (n < p.size())
+    {
+        std::fill(out, out + width - low_width, '0');
+        write_decimal(out + width - low_width, low_width, x, n, powers);
+        return;
+    }
+
+    storage_t q(n - p.size() + 1);
+    storage_t r(p.size());
+    limbs::divrem(q.data(), r.data(), x, n, p.data(), p.size());
+    write_decimal(out, width - low_width, q.data(), q.size(), powers);
+    write_decimal(out + width - low_width, low_width, r.data(), r.size(), powers);
+}
+
+// the value of the decimal digits s[0, len), split like write_decimal so that the halves
+// are joined by one product with a cached power of ten
+storage_t read_decimal(char const* s, size_t len, std::vector<storage_t> const& powers)
+{
+    if (len <= decimal_digits * decimal_basecase)
+    {
+        storage_t r;
+        size_t chunk_len = len % decimal_digits;
+        if (chunk_len == 0)
+            chunk_len = decimal_digits;
+        for (char const* end = s + len; s != end; s += chunk_len, chunk_len = decimal_digits)
+        {
+            limb_t chunk = 0;
+            for (size_t i = 0; i != chunk_len; ++i)
+                chunk = chunk * 10 + static_cast<limb_t>(s[i] - '0');
+
+            limb_t carry = limbs::mul_1(r.data(), r.data(), r.size(), pow10(chunk_len));
+            if (carry != 0)
+                r.push_back(carry);
+            carry = limbs::add_1(r.data(), r.data(), r.size(), chunk);
+            if (carry != 0)
+                r.push_back(carry);
+        }
+        return r;
+    }
+
+    size_t k = 0;
+    while (k + 1 != powers.size() && 2 * (decimal_digits << (k + 1)) <= len)
+        ++k;
+    size_t low_len = decimal_digits << k;
+    storage_t high = read_decimal(s, len - low_len, powers);
+    storage_t low = read_decimal(s + len - low_len, low_len, powers);
+    storage_t const& p = powers[k];
+
+    // high 10^low_len + low < (high + 1) p
+    storage_t r(high.size() + p.size());
+    if (high.size() >= p.size())
+        limbs::mul(r.data(), high.data(), high.size(), p.data(), p.size());
+    else if (!high.empty())
+        limbs::mul(r.data(), p.data(), p.size(), high.data(), high.size());
+    limbs::add(r.data(), r.data(), r.size(), low.data(), low.size());
+    r.resize(limbs::normalized_size(r.data(), r.size()));
+    return r;
+}
+
+big_integer power_of_two(size_t k)
 {
-    mpz_init(mpz);
+    return big_integer(1) << k;
 }
 
+// floor(2^(2k) / d) for d with exactly k bits. The reciprocal of the top half of d
+// is extended by one Newton step x' = x + x (1 - d x), which doubles its precision,
+// and then corrected to the exact floor.
+big_integer newton_reciprocal(big_integer const& d, size_t k)
+{
+    if (k <= limbs::newton_basecase_threshold * limbs::limb_bits)
+        return power_of_two(2 * k) / d;
+
+    size_t h = k / 2 + 1;
+    size_t low = k - h;
+    big_integer v = newton_reciprocal(d >> low, h);
+
+    // x = v 2^low, e = 2^(2k) - d x; |e| < 2^(2k - h + 2), so the bits of e below 2^(k - 4)
+    // change the correction x e / 2^(2k) by less than one and need not be multiplied
+    big_integer e = power_of_two(2 * k) - ((d * v) << low);
+    big_integer delta = (v * (e >> (k - 4))) >> (h + 4);
+    big_integer x = (v << low) + delta;
+    e -= d * delta;
+    while (e < 0)
+    {
+        --x;
+        e += d;
+    }
+    while (e >= d)
+    {
+        ++x;
+        e -= d;
+    }
+    return x;
+}
+}
+
+big_integer::big_integer()
+    : negative(false)
+{}
+
 big_integer::big_integer(big_integer const& other)
+    : negative(other.negative)
+    , mag(other.mag)
+{
+#ifdef BIG_INTEGER_CACHED_HASH
+    hash_cache = other.hash_cache;
+#endif
+}
+
+big_integer::big_integer(big_integer&& other) noexcept
+    : negative(other.negative)
+    , mag(std::move(other.mag))
 {
-    mpz_init_set(mpz, other.mpz);
+#ifdef BIG_INTEGER_CACHED_HASH
+    hash_cache = other.hash_cache;
+#endif
+    other.negative = false;
+    other.mag.clear();
+    other.invalidate_hash();
 }
 
 big_integer::big_integer(int a)
+    : negative(a < 0)
 {
-    mpz_init_set_si(mpz, a);
+    if (a != 0)
+        mag.push_back(negative ? limb_t(0) - static_cast<limb_t>(a) : static_cast<limb_t>(a));
 }
 
-big_integer::big_integer(std::string const& str)
+big_integer::big_integer(std::string_view str)
+    : big_integer(str.data(), str.size())
+{}
+
+big_integer::big_integer(char const* str, size_t len)
+    : negative(false)
 {
-    if (mpz_init_set_str(mpz, str.c_str(), 10))
-    {
-        mpz_clear(mpz);
+    size_t pos = (len != 0 && str[0] == '-') ? 1 : 0;
+    if (pos == len)
         throw std::runtime_error("invalid string");
+    for (size_t i = pos; i != len; ++i)
+    {
+        if (str[i] < '0' || str[i] > '9')
+            throw std::runtime_error("invalid string");
     }
+
+    mag = read_decimal(str + pos, len - pos, decimal_powers(len - pos));
+    negative = pos == 1 && !mag.empty();
 }
 
-big_integer::~big_integer()
+big_integer::~big_integer() = default;
+
+big_integer& big_integer::operator=(big_integer const& other)
 {
-    mpz_clear(mpz);
+    negative = other.negative;
+    mag = other.mag;
+#ifdef BIG_INTEGER_CACHED_HASH
+    hash_cache = other.hash_cache;
+#endif
+    return *this;
 }
 
-big_integer& big_integer::operator=(big_integer const& other)
+big_integer& big_integer::operator=(big_integer&& other) noexcept
 {
-    mpz_set(mpz, other.mpz);
+    if (this != &other)
+    {
+        negative = other.negative;
+        mag = std::move(other.mag);
+#ifdef BIG_INTEGER_CACHED_HASH
+        hash_cache = other.hash_cache;
+#endif
+        other.negative = false;
+        other.mag.clear();
+        other.invalidate_hash();
+    }
     return *this;
 }
 
+void big_integer::swap(big_integer& other) noexcept
+{
+    std::swap(negative, other.negative);
+    mag.swap(other.mag);
+#ifdef BIG_INTEGER_CACHED_HASH
+    std::swap(hash_cache, other.hash_cache);
+#endif
+}
+
+void swap(big_integer& a, big_integer& b) noexcept
+{
+    a.swap(b);
+}
+
+void big_integer::normalize()
+{
+    while (!mag.empty() && mag.back() == 0)
+        mag.pop_back();
+    if (mag.empty())
+        negative = false;
+}
+
+big_integer::operand big_integer::view() const
+{
+    return operand{negative, mag.data(), mag.size()};
+}
+
+void big_integer::assign(operand a)
+{
+    invalidate_hash();
+    negative = a.negative;
+    mag.assign(a.data, a.data + a.size);
+}
+
+void big_integer::add(operand rhs)
+{
+    invalidate_hash();
+    if (negative == rhs.negative)
+        add_magnitude(rhs);
+    else
+        sub_magnitude(rhs);
+}
+
+void big_integer::subtract(operand rhs)
+{
+    invalidate_hash();
+    if (negative != rhs.negative)
+        add_magnitude(rhs);
+    else
+        sub_magnitude(rhs);
+}
+
+void big_integer::add_magnitude(operand rhs)
+{
+    size_t an = mag.size();
+    size_t bn = rhs.size;
+    // rhs may view *this, whose buffer moves on resize
+    bool aliased = rhs.data == mag.data();
+    // the carry limb is appended only when there is one, which keeps small sums inline
+    // in storage that has room for a few limbs
+    mag.resize(std::max(an, bn));
+    limb_t* r = mag.data();
+    limb_t const* b = aliased ? r : rhs.data;
+    limb_t carry = an >= bn ? limbs::add(r, r, an, b, bn) : limbs::add(r, b, bn, r, an);
+    if (carry != 0)
+        mag.push_back(carry);
+}
+
+void big_integer::sub_magnitude(operand rhs)
+{
+    size_t an = mag.size();
+    size_t bn = rhs.size;
+    int c = limbs::cmp(mag.data(), an, rhs.data, bn);
+    if (c == 0)
+    {
+        mag.clear();
+        negative = false;
+        return;
+    }
+    if (c > 0)
+    {
+        limbs::sub(mag.data(), mag.data(), an, rhs.data, bn);
+    }
+    else
+    {
+        // |rhs| > |this|, so rhs is not a view of *this
+        mag.resize(bn);
+        limbs::sub(mag.data(), rhs.data, bn, mag.data(), an);
+        negative = !negative;
+    }
+    normalize();
+}
+
 big_integer& big_integer::operator+=(big_integer const& rhs)
 {
-    mpz_add(mpz, mpz, rhs.mpz);
+    add(rhs.view());
     return *this;
 }
 
 big_integer& big_integer::operator-=(big_integer const& rhs)
 {
-    mpz_sub(mpz, mpz, rhs.mpz);
+    subtract(rhs.view());
+    return *this;
+}
+
+big_integer& big_integer::addmul(big_integer const& y, big_integer const& z)
+{
+    multiply_accumulate(y, z, false);
+    return *this;
+}
+
+big_integer& big_integer::submul(big_integer const& y, big_integer const& z)
+{
+    multiply_accumulate(y, z, true);
     return *this;
 }
 
+void big_integer::multiply_accumulate(big_integer const& y, big_integer const& z, bool subtract)
+{
+    invalidate_hash();
+    if (y.mag.empty() || z.mag.empty())
+        return;
+    if (this == &y || this == &z)
+    {
+        big_integer p = y;
+        p *= z;
+        if (subtract)
+            *this -= p;
+        else
+            *this += p;
+        return;
+    }
+
+    bool p_negative = (y.negative != z.negative) != subtract;
+    storage_t const& a = y.mag.size() >= z.mag.size() ? y.mag : z.mag;
+    storage_t const& b = y.mag.size() >= z.mag.size() ? z.mag : y.mag;
+    size_t n = std::max(mag.size(), a.size() + b.size());
+    if (mag.empty() || negative == p_negative)
+    {
+        negative = p_negative;
+        mag.resize(n + 1);
+        limbs::addmul(mag.data(), n + 1, a.data(), a.size(), b.data(), b.size());
+    }
+    else
+    {
+        mag.resize(n);
+        if (limbs::submul(mag.data(), n, a.data(), a.size(), b.data(), b.size()) != 0)
+        {
+            // |p| > |this|: the limbs hold B^n - (|p| - |this|)
+            for (limb_t& l : mag)
+                l = ~l;
+            limbs::add_1(mag.data(), mag.data(), n, 1);
+            negative = !negative;
+        }
+    }
+    normalize();
+}
+
 big_integer& big_integer::operator*=(big_integer const& rhs)
 {
-    mpz_mul(mpz, mpz, rhs.mpz);
+    multiply(rhs.view());
     return *this;
 }
 
+void big_integer::multiply(operand rhs)
+{
+    invalidate_hash();
+    if (mag.empty() || rhs.size == 0)
+    {
+        mag.clear();
+        negative = false;
+        return;
+    }
+
+    negative = negative != rhs.negative;
+    size_t an = mag.size();
+    size_t bn = rhs.size;
+    if (bn == 1)
+    {
+        limb_t carry = limbs::mul_1(mag.data(), mag.data(), an, rhs.data[0]);
+        if (carry != 0)
+            mag.push_back(carry);
+        return;
+    }
+
+    storage_t r(an + bn);
+    // a *= a, and also a * a, which arrives with a copy of a on the left: comparing the
+    // limbs costs nothing next to the product and the square does half the work
+    if (an == bn && (rhs.data == mag.data() || std::equal(mag.begin(), mag.end(), rhs.data)))
+        limbs::sqr(r.data(), mag.data(), an);
+    else if (an >= bn)
+        limbs::mul(r.data(), mag.data(), an, rhs.data, bn);
+    else
+        limbs::mul(r.data(), rhs.data, bn, mag.data(), an);
+    mag.swap(r);
+    normalize();
+}
+
+void big_integer::divide(big_integer const& a, operand b, big_integer* quotient, big_integer* remainder)
+{
+    if (b.size == 0)
+        throw std::runtime_error("division by zero");
+
+    size_t an = a.mag.size();
+    size_t bn = b.size;
+    if (an < bn)
+    {
+        if (remainder != nullptr && remainder != &a)
+            *remainder = a;
+        if (quotient != nullptr)
+            *quotient = 0;
+        return;
+    }
+
+    if (quotient != nullptr)
+        quotient->invalidate_hash();
+    if (remainder != nullptr)
+        remainder->invalidate_hash();
+
+    bool q_negative = a.negative != b.negative;
+    bool r_negative = a.negative;
+    if (bn == 1)
+    {
+        // in place when the quotient replaces the dividend
+        limb_t d = b.data[0];
+        limb_t rem;
+        if (quotient != nullptr)
+        {
+            quotient->mag.resize(an);
+            rem = limbs::divrem_1(quotient->mag.data(), a.mag.data(), an, d);
+            quotient->negative = q_negative;
+            quotient->normalize();
+        }
+        else
+        {
+            rem = limbs::mod_1(a.mag.data(), an, d);
+        }
+        if (remainder != nullptr)
+        {
+            remainder->mag.assign(rem != 0 ? 1 : 0, rem);
+            remainder->negative = r_negative && rem != 0;
+        }
+        return;
+    }
+
+    if (bn > limbs::newton_threshold && an - bn > limbs::newton_threshold)
+    {
+        big_integer divisor;
+        divisor.assign(b);
+        std::pair<big_integer, big_integer> qr = divmod(a, big_integer_reciprocal(divisor));
+        if (quotient != nullptr)
+        {
+            quotient->mag.swap(qr.first.mag);
+            quotient->negative = qr.first.negative;
+        }
+        if (remainder != nullptr)
+        {
+            remainder->mag.swap(qr.second.mag);
+            remainder->negative = qr.second.negative;
+        }
+        return;
+    }
+
+    storage_t q(an - bn + 1);
+    storage_t r(bn);
+    limbs::divrem(q.data(), r.data(), a.mag.data(), an, b.data, bn);
+    if (quotient != nullptr)
+    {
+        quotient->mag.swap(q);
+        quotient->negative = q_negative;
+        quotient->normalize();
+    }
+    if (remainder != nullptr)
+    {
+        remainder->mag.swap(r);
+        remainder->negative = r_negative;
+        remainder->normalize();
+    }
+}
+
 big_integer& big_integer::operator/=(big_integer const& rhs)
 {
-    mpz_tdiv_q(mpz, mpz, rhs.mpz);
+    divide(*this, rhs.view(), this, nullptr);
     return *this;
 }
 
 big_integer& big_integer::operator%=(big_integer const& rhs)
 {
-    mpz_tdiv_r(mpz, mpz, rhs.mpz);
+    divide(*this, rhs.view(), nullptr, this);
+    return *this;
+}
+
+std::pair<big_integer, big_integer> divmod(big_integer const& a, big_integer const& b)
+{
+    std::pair<big_integer, big_integer> res;
+    big_integer::divide(a, b.view(), &res.first, &res.second);
+    return res;
+}
+
+big_integer_reciprocal::big_integer_reciprocal(big_integer const& divisor)
+    : negative(divisor.negative)
+    , magnitude(divisor)
+{
+    if (divisor.mag.empty())
+        throw std::runtime_error("division by zero");
+    magnitude.negative = false;
+    bits = magnitude.bit_length();
+    inverse = newton_reciprocal(magnitude, bits);
+}
+
+std::pair<big_integer, big_integer> divmod(big_integer const& a, big_integer_reciprocal const& b)
+{
+    size_t const k = b.bits;
+    big_integer const& d = b.magnitude;
+    // |a| is consumed in blocks of whole limbs, at most k bits each, so that every step
+    // divides a value below 2^(2k) and yields a quotient digit below 2^block_bits
+    size_t const block = k / limbs::limb_bits;
+    if (block == 0)
+        return divmod(a, b.negative ? -d : d);
+
+    size_t an = a.mag.size();
+    size_t blocks = (an + block - 1) / block;
+    std::pair<big_integer, big_integer> res;
+    big_integer& q = res.first;
+    big_integer& r = res.second;
+    q.mag.resize(blocks * block);
+
+    big_integer t;
+    for (size_t i = blocks; i-- != 0;)
+    {
+        // t = r B^block + block i of |a|
+        size_t lo = i * block;
+        size_t hi = std::min(an, lo + block);
+        t.mag.resize(block + r.mag.size());
+        std::copy(a.mag.begin() + lo, a.mag.begin() + hi, t.mag.begin());
+        std::fill(t.mag.begin() + (hi - lo), t.mag.begin() + block, limb_t(0));
+        std::copy(r.mag.begin(), r.mag.end(), t.mag.begin() + block);
+        t.normalize();
+
+        // Barrett: the estimate is at most two below the true quotient digit
+        big_integer qi = ((t >> (k - 1)) * b.inverse) >> (k + 1);
+        r = t - qi * d;
+        while (r >= d)
+        {
+            ++qi;
+            r -= d;
+        }
+        std::copy(qi.mag.begin(), qi.mag.end(), q.mag.begin() + lo);
+    }
+
+    q.negative = a.negative != b.negative;
+    q.normalize();
+    r.negative = a.negative;
+    r.normalize();
+    return res;
+}
+
+namespace
+{
+// sliding window width for an exponent of the given bit length, trading 2^(k-1)
+// precomputed odd powers against about bits / (k + 1) multiplications
+unsigned window_bits(size_t bits)
+{
+    size_t const limits[] = {7, 36, 140, 450, 1303, 3529};
+    unsigned k = 1;
+    while (k <= 6 && bits > limits[k - 1])
+        ++k;
+    return k;
+}
+
+bool test_bit(limb_t const* e, size_t i)
+{
+    return ((e[i / limbs::limb_bits] >> (i % limbs::limb_bits)) & 1) != 0;
+}
+
+// base^e for e[0, en) with e[en - 1] != 0. The exponent is scanned from the top in windows
+// that start and end with a one bit, so only odd powers of base are precomputed.
+// Field::element is the residue type, Field::mul and Field::sqr work in place.
+template <typename Field>
+typename Field::element window_pow(Field& f, typename Field::element const& base, limb_t const* e, size_t en)
+{
+    typedef typename Field::element element;
+    size_t bits = en * limbs::limb_bits - limbs::count_leading_zeros(e[en - 1]);
+    unsigned k = window_bits(bits);
+
+    // odd[j] = base^(2j + 1)
+    std::vector<element> odd(size_t(1) << (k - 1), base);
+    if (k > 1)
+    {
+        element sq = base;
+        f.sqr(sq);
+        for (size_t j = 1; j != odd.size(); ++j)
+        {
+            odd[j] = odd[j - 1];
+            f.mul(odd[j], sq);
+        }
+    }
+
+    // the top bit is set, so the first window initializes r before any square of it
+    element r;
+    bool started = false;
+    size_t i = bits;
+    while (i != 0)
+    {
+        if (!test_bit(e, i - 1))
+        {
+            f.sqr(r);
+            --i;
+            continue;
+        }
+        size_t low = i > k ? i - k : 0;
+        while (!test_bit(e, low))
+            ++low;
+        size_t w = 0;
+        for (size_t j = i; j-- != low;)
+            w = 2 * w + (test_bit(e, j) ? 1 : 0);
+        if (started)
+        {
+            for (size_t j = low; j != i; ++j)
+                f.sqr(r);
+            f.mul(r, odd[w / 2]);
+        }
+        else
+        {
+            r = odd[w / 2];
+            started = true;
+        }
+        i = low;
+    }
+    return r;
+}
+
+// residues of n limbs in Montgomery form; the product and its scratch are allocated once,
+// so a modular product below limbs::ntt_threshold allocates nothing
+struct montgomery_field
+{
+    typedef storage_t element;
+
+    montgomery_field(storage_t const& m, limb_t minv)
+        : m(m.data())
+        , n(m.size())
+        , minv(minv)
+        , ntt(n >= limbs::ntt_threshold)
+        , t(2 * n + (ntt ? 0 : std::max(limbs::mul_n_scratch_size(n), limbs::sqr_n_scratch_size(n))))
+    {}
+
+    void mul(element& x, element const& y)
+    {
+        if (ntt)
+            limbs::mul(t.data(), x.data(), n, y.data(), n);
+        else
+            limbs::mul_n(t.data(), x.data(), y.data(), n, t.data() + 2 * n);
+        limbs::redc(x.data(), t.data(), m, n, minv);
+    }
+
+    void sqr(element& x)
+    {
+        if (ntt)
+            limbs::sqr(t.data(), x.data(), n);
+        else
+            limbs::sqr_n(t.data(), x.data(), n, t.data() + 2 * n);
+        limbs::redc(x.data(), t.data(), m, n, minv);
+    }
+
+    limb_t const* m;
+    size_t n;
+    limb_t minv;
+    bool ntt;
+    storage_t t;
+};
+
+// Residues modulo any m of n limbs, reduced by Barrett's method with mu = floor(B^2n / m):
+// for x < m^2 the quotient estimate ((x / B^(n-1)) mu) / B^(n+1) is at most two below x / m.
+struct barrett_field
+{
+    typedef big_integer element;
+
+    barrett_field(big_integer const& m, size_t n)
+        : m(m)
+        , n(n)
+        , mu((big_integer(1) << (2 * n * limbs::limb_bits)) / m)
+    {}
+
+    void reduce(big_integer& x) const
+    {
+        big_integer q = x >> ((n - 1) * limbs::limb_bits);
+        q *= mu;
+        q >>= (n + 1) * limbs::limb_bits;
+        x.submul(q, m);
+        while (x >= m)
+            x -= m;
+    }
+
+    void mul(element& x, element const& y) const
+    {
+        x *= y;
+        reduce(x);
+    }
+
+    void sqr(element& x) const
+    {
+        x *= x;
+        reduce(x);
+    }
+
+    big_integer const& m;
+    size_t n;
+    big_integer mu;
+};
+
+// bit i is set when i is a square modulo m, for m <= 128
+constexpr limbs::dlimb_t square_residues(unsigned m)
+{
+    limbs::dlimb_t r = 0;
+    for (unsigned i = 0; i != m; ++i)
+        r |= limbs::dlimb_t(1) << (i * i % m);
+    return r;
+}
+
+// about 1 in 120 non-squares passes all four
+constexpr limbs::dlimb_t square_residues_64 = square_residues(64);
+constexpr limbs::dlimb_t square_residues_63 = square_residues(63);
+constexpr limbs::dlimb_t square_residues_65 = square_residues(65);
+constexpr limbs::dlimb_t square_residues_11 = square_residues(11);
+
+// a mod |m| in [0, |m|)
+big_integer residue(big_integer const& a, big_integer const& m)
+{
+    big_integer r = a % m;
+    if (r < 0)
+        r += m < 0 ? -m : m;
+    return r;
+}
+}
+
+montgomery_context::montgomery_context(big_integer const& modulus)
+    : m(modulus < 0 ? -modulus : modulus)
+{
+    if (m.mag.empty() || (m.mag[0] & 1) == 0 || m == 1)
+        throw std::runtime_error("montgomery modulus must be odd and greater than 1");
+    // Newton iteration doubles the number of correct low bits of m^-1 every step
+    limb_t inv = m.mag[0];
+    for (int i = 0; i != 5; ++i)
+        inv *= 2 - m.mag[0] * inv;
+    minv = limb_t(0) - inv;
+    r2 = (big_integer(1) << (2 * m.mag.size() * limbs::limb_bits)) % m;
+}
+
+big_integer const& montgomery_context::modulus() const
+{
+    return m;
+}
+
+big_integer montgomery_context::to_montgomery(big_integer const& x) const
+{
+    return multiply(residue(x, m), r2);
+}
+
+big_integer montgomery_context::from_montgomery(big_integer const& x) const
+{
+    size_t n = m.mag.size();
+    storage_t t(2 * n);
+    std::copy(x.mag.begin(), x.mag.end(), t.begin());
+    big_integer r;
+    r.mag.resize(n);
+    limbs::redc(r.mag.data(), t.data(), m.mag.data(), n, minv);
+    r.normalize();
+    return r;
+}
+
+big_integer montgomery_context::multiply(big_integer const& a, big_integer const& b) const
+{
+    size_t n = m.mag.size();
+    montgomery_field f(m.mag, minv);
+    big_integer r = a;
+    r.invalidate_hash();
+    r.mag.resize(n);
+    if (&a == &b)
+    {
+        f.sqr(r.mag);
+    }
+    else
+    {
+        storage_t y = b.mag;
+        y.resize(n);
+        f.mul(r.mag, y);
+    }
+    r.normalize();
+    return r;
+}
+
+big_integer montgomery_context::pow(big_integer const& base, big_integer const& exp) const
+{
+    if (exp.negative)
+        throw std::runtime_error("negative exponent");
+    if (exp.mag.empty())
+        return 1;
+
+    size_t n = m.mag.size();
+    montgomery_field f(m.mag, minv);
+    big_integer b = to_montgomery(base);
+    b.mag.resize(n);
+    big_integer r;
+    r.mag = window_pow(f, b.mag, exp.mag.data(), exp.mag.size());
+    r.normalize();
+    return from_montgomery(r);
+}
+
+big_integer powmod(big_integer const& base, big_integer const& exp, big_integer const& mod)
+{
+    if (mod.mag.empty())
+        throw std::runtime_error("division by zero");
+    if (exp.negative)
+        throw std::runtime_error("negative exponent");
+    big_integer m = mod < 0 ? -mod : mod;
+    if (m == 1)
+        return 0;
+    if ((m.mag[0] & 1) != 0)
+        return montgomery_context(m).pow(base, exp);
+    if (exp.mag.empty())
+        return 1;
+
+    barrett_field f(m, m.mag.size());
+    return window_pow(f, residue(base, m), exp.mag.data(), exp.mag.size());
+}
+
+// The gcd engine keeps a pair a >= b >= 0 and replaces it by unimodular combinations of
+// itself, which leave the gcd unchanged whatever they are: the quotients may come from
+// approximations, as long as the result is fixed up to nonnegative and ordered.
+struct big_integer_gcd
+{
+    // rows are the coefficients of the current pair over an earlier one; only the first
+    // cols columns are kept
+    struct matrix
+    {
+        big_integer m[2][2];
+        size_t cols;
+    };
+
+    // bits [shift, shift + 128) of a
+    static limbs::dlimb_t leading(big_integer const& a, size_t shift)
+    {
+        size_t i = shift / limbs::limb_bits;
+        unsigned c = shift % limbs::limb_bits;
+        auto at = [&a](size_t j) { return limbs::dlimb_t(j < a.mag.size() ? a.mag[j] : 0); };
+        limbs::dlimb_t r = at(i) | at(i + 1) << limbs::limb_bits;
+        if (c != 0)
+            r = r >> c | at(i + 2) << (2 * limbs::limb_bits - c);
+        return r;
+    }
+
+    // (a, b) <- (b, a mod b)
+    static void division_step(big_integer& a, big_integer& b, matrix* c)
+    {
+        big_integer q;
+        big_integer::divide(a, b.view(), &q, &a);
+        a.swap(b);
+        if (c)
+        {
+            for (size_t j = 0; j != c->cols; ++j)
+            {
+                c->m[0][j].submul(q, c->m[1][j]);
+                c->m[0][j].swap(c->m[1][j]);
+            }
+        }
+    }
+
+    // u x - v y. The cofactors of two consecutive remainders have opposite signs, so the
+    // magnitudes add up in one pass; the pair after a fixup may not, and takes the long way.
+    static big_integer combination(big_integer const& x, limb_t u, big_integer const& y, limb_t v)
+    {
+        if (!x.mag.empty() && !y.mag.empty() && x.negative == y.negative)
+        {
+            big_integer r = x * u;
+            r -= y * v;
+            return r;
+        }
+
+        size_t xn = x.mag.size();
+        size_t yn = y.mag.size();
+        size_t n = std::max(xn, yn) + 1;
+        big_integer r;
+        r.mag.assign(n, 0);
+        if (xn != 0)
+            r.mag[xn] = limbs::mul_1(r.mag.data(), x.mag.data(), xn, u);
+        if (yn != 0)
+        {
+            limb_t carry = limbs::addmul_1(r.mag.data(), y.mag.data(), yn, v);
+            limbs::add_1(r.mag.data() + yn, r.mag.data() + yn, n - yn, carry);
+        }
+        r.negative = xn != 0 ? x.negative : !y.negative;
+        r.normalize();
+        return r;
+    }
+
+    // one batch of Lehmer steps from the leading 128 bits, keeping b above s bits where
+    // the approximation allows it
+    static void lehmer_step(big_integer& a, big_integer& b, size_t s, matrix* c)
+    {
+        size_t bits = a.bit_length();
+        size_t shift = bits > 2 * limbs::limb_bits ? bits - 2 * limbs::limb_bits : 0;
+        limbs::dlimb_t ymin = s > shift ? limbs::dlimb_t(1) << (s - shift) : 0;
+        limb_t u[2], v[2];
+        size_t k = limbs::hgcd2(leading(a, shift), leading(b, shift), ymin, shift == 0, u, v);
+        if (k == 0)
+        {
+            division_step(a, b, c);
+            return;
+        }
+
+        // both combinations are nonnegative: the error from the low bits is below 2^shift
+        // times the larger cofactor, and the quotients stop before it can change a sign
+        size_t n = a.mag.size();
+        b.mag.resize(n);
+        storage_t x(n + 1), y(n + 1);
+        if (k % 2 == 0)
+        {
+            x[n] = limbs::mul_1(x.data(), a.mag.data(), n, u[0]);
+            x[n] -= limbs::submul_1(x.data(), b.mag.data(), n, v[0]);
+            y[n] = limbs::mul_1(y.data(), b.mag.data(), n, v[1]);
+            y[n] -= limbs::submul_1(y.data(), a.mag.data(), n, u[1]);
+        }
+        else
+        {
+            x[n] = limbs::mul_1(x.data(), b.mag.data(), n, v[0]);
+            x[n] -= limbs::submul_1(x.data(), a.mag.data(), n, u[0]);
+            y[n] = limbs::mul_1(y.data(), a.mag.data(), n, u[1]);
+            y[n] -= limbs::submul_1(y.data(), b.mag.data(), n, v[1]);
+        }
+        a.mag.swap(x);
+        b.mag.swap(y);
+        a.normalize();
+        b.normalize();
+
+        if (c)
+        {
+            for (size_t j = 0; j != c->cols; ++j)
+            {
+                big_integer r0 = combination(c->m[0][j], u[0], c->m[1][j], v[0]);
+                big_integer r1 = combination(c->m[0][j], u[1], c->m[1][j], v[1]);
+                c->m[0][j] = k % 2 == 0 ? std::move(r0) : -std::move(r0);
+                c->m[1][j] = k % 2 == 0 ? -std::move(r1) : std::move(r1);
+            }
+        }
+        // the last quotient may be one too large when the approximation ends on a tie
+        if (a < b)
+        {
+            a.swap(b);
+            if (c)
+                for (size_t j = 0; j != c->cols; ++j)
+                    c->m[0][j].swap(c->m[1][j]);
+        }
+    }
+
+    // (a, b) <- r (a, b), with rows of r negated and swapped so that a >= b >= 0.
+    // Returns false and leaves a and b alone unless the pair gets smaller.
+    static bool apply(matrix& r, big_integer& a, big_integer& b)
+    {
+        big_integer x = r.m[0][0] * a;
+        x.addmul(r.m[0][1], b);
+        big_integer y = r.m[1][0] * a;
+        y.addmul(r.m[1][1], b);
+        for (size_t i = 0; i != 2; ++i)
+        {
+            big_integer& z = i == 0 ? x : y;
+            if (z.negative)
+            {
+                z.negative = false;
+                for (size_t j = 0; j != 2; ++j)
+                    r.m[i][j] = -std::move(r.m[i][j]);
+            }
+        }
+        if (x < y)
+        {
+            x.swap(y);
+            for (size_t j = 0; j != 2; ++j)
+                r.m[0][j].swap(r.m[1][j]);
+        }
+        if (x > a || (x == a && y >= b))
+            return false;
+        a.swap(x);
+        b.swap(y);
+        return true;
+    }
+
+    // c <- r c
+    static void compose(matrix& r, matrix& c)
+    {
+        // the first batch of a recursive call lands on the identity
+        if (c.m[0][0] == 1 && c.m[1][0] == 0 && (c.cols == 1 || (c.m[0][1] == 0 && c.m[1][1] == 1)))
+        {
+            for (size_t j = 0; j != c.cols; ++j)
+            {
+                c.m[0][j].swap(r.m[0][j]);
+                c.m[1][j].swap(r.m[1][j]);
+            }
+            return;
+        }
+        for (size_t j = 0; j != c.cols; ++j)
+        {
+            big_integer r0 = r.m[0][0] * c.m[0][j];
+            r0.addmul(r.m[0][1], c.m[1][j]);
+            big_integer r1 = r.m[1][0] * c.m[0][j];
+            r1.addmul(r.m[1][1], c.m[1][j]);
+            c.m[0][j].swap(r0);
+            c.m[1][j].swap(r1);
+        }
+    }
+
+    // Reduces a >= b >= 0 until b has at most s bits, composing the steps into *c.
+    // When s is well above half of the n bits of a, the steps are found from the leading
+    // bits alone: reducing the top 2 (n - s) + O(1) bits to about their half fixes the
+    // quotients, and the matrix of cofactors is applied to the full pair by four products.
+    // Below that, the pair is first brought down to about half of its bits, which makes
+    // the leading-bits case apply to the rest.
+    static void reduce(big_integer& a, big_integer& b, size_t s, matrix* c)
+    {
+        size_t const margin = limbs::limb_bits;
+        while (b.bit_length() > s)
+        {
+            size_t n = a.bit_length();
+            // splitting off less than a quarter of the bits costs more in products than it saves
+            size_t low = std::max<size_t>(n / 4, limbs::limb_bits);
+            if (a.mag.size() < limbs::hgcd_threshold)
+            {
+                lehmer_step(a, b, s, c);
+            }
+            else if (2 * s >= n + 2 * margin + low)
+            {
+                size_t p = 2 * s - n - 2 * margin;
+                big_integer x = a >> p;
+                big_integer y = b >> p;
+                matrix r{{{1, 0}, {0, 1}}, 2};
+                reduce(x, y, s - p, &r);
+                if (!apply(r, a, b))
+                    division_step(a, b, c);
+                else if (c)
+                    compose(r, *c);
+            }
+            else
+            {
+                // halfway to s, but high enough for the leading-bits case to apply
+                size_t half = std::max(n - (n - s) / 2, (n + 2 * margin + low + 1) / 2);
+                if (b.bit_length() > half)
+                    reduce(a, b, half, c);
+                else
+                    division_step(a, b, c);
+            }
+        }
+    }
+
+    // Euclid's algorithm until b has at most s bits: Lehmer steps on the full pair below
+    // gcd_threshold limbs, where they beat the products that apply half-gcd matrices
+    static void euclid(big_integer& a, big_integer& b, size_t s, matrix* c)
+    {
+        while (b.bit_length() > s)
+        {
+            size_t half = a.bit_length() / 2;
+            if (a.mag.size() < limbs::gcd_threshold)
+                lehmer_step(a, b, s, c);
+            else if (b.bit_length() > half)
+                reduce(a, b, half, c);
+            else
+                division_step(a, b, c);
+        }
+    }
+
+    static big_integer magnitude(big_integer const& a)
+    {
+        big_integer r;
+        r.mag = a.mag;
+        return r;
+    }
+};
+
+big_integer gcd(big_integer const& a, big_integer const& b)
+{
+    big_integer x = big_integer_gcd::magnitude(a);
+    big_integer y = big_integer_gcd::magnitude(b);
+    if (x < y)
+        x.swap(y);
+    big_integer_gcd::euclid(x, y, limbs::limb_bits, nullptr);
+    if (y.mag.empty())
+        return x;
+    limb_t r = limbs::mod_1(x.mag.data(), x.mag.size(), y.mag[0]);
+    return limbs::gcd_1(y.mag[0], r);
+}
+
+big_integer lcm(big_integer const& a, big_integer const& b)
+{
+    if (a == 0 || b == 0)
+        return 0;
+    big_integer r = a / gcd(a, b) * b;
+    return r < 0 ? -std::move(r) : r;
+}
+
+std::tuple<big_integer, big_integer, big_integer> gcdext(big_integer const& a, big_integer const& b)
+{
+    if (b.mag.empty())
+        return {big_integer_gcd::magnitude(a), a.mag.empty() ? 0 : a.negative ? -1 : 1, 0};
+
+    // the first column follows the coefficient of |a| in the pair
+    big_integer x = big_integer_gcd::magnitude(a);
+    big_integer y = big_integer_gcd::magnitude(b);
+    big_integer_gcd::matrix c{{{1, 0}, {0, 0}}, 1};
+    if (x < y)
+    {
+        x.swap(y);
+        c.m[0][0].swap(c.m[1][0]);
+    }
+    big_integer_gcd::euclid(x, y, 0, &c);
+
+    // the coefficients of a solution are unique modulo (b / g, a / g); take the smallest s
+    big_integer m = big_integer_gcd::magnitude(b) / x;
+    big_integer s = residue(c.m[0][0], m);
+    if (s.compare(m >> 1) > 0)
+        s -= m;
+    if (a.negative)
+        s = -std::move(s);
+    big_integer t = x;
+    t.submul(s, a);
+    t /= b;
+    return {std::move(x), std::move(s), std::move(t)};
+}
+
+big_integer modinv(big_integer const& a, big_integer const& m)
+{
+    if (m == 0)
+        throw std::runtime_error("division by zero");
+    auto [g, s, t] = gcdext(residue(a, m), m);
+    if (g != 1)
+        throw std::runtime_error("not invertible");
+    return residue(s, m);
+}
+
+// Roots run Newton's iteration x' = ((k - 1) x + a / x^(k-1)) / k on integers: started
+// anywhere above the floor of the root, it decreases to the floor and stays there.
+struct big_integer_root
+{
+    // x^k by squaring
+    static big_integer power(big_integer x, uint64_t k)
+    {
+        big_integer r = 1;
+        for (;;)
+        {
+            if (k & 1)
+                r *= x;
+            k >>= 1;
+            if (k == 0)
+                return r;
+            x *= x;
+        }
+    }
+
+    // floor(a^(1/k)) for a > 0 whose root fits in 32 bits, from a floating point estimate
+    // that is off by at most one
+    static big_integer small_root(big_integer const& a, uint64_t k)
+    {
+        size_t bits = a.bit_length();
+        size_t shift = bits > limbs::limb_bits ? bits - limbs::limb_bits : 0;
+        limb_t top = (a >> shift).mag[0];
+        double log2a = std::log2(static_cast<double>(top)) + static_cast<double>(shift);
+        big_integer r = static_cast<limb_t>(std::exp2(log2a / static_cast<double>(k)));
+        while (r > 0 && power(r, k) > a)
+            --r;
+        while (power(r + 1, k) <= a)
+            ++r;
+        return r;
+    }
+
+    // floor(a^(1/k)) for a > 0 and k >= 3
+    static big_integer root(big_integer const& a, uint64_t k)
+    {
+        size_t bits = a.bit_length();
+        if (k >= bits)
+            return 1;
+        size_t root_bits = (bits + k - 1) / k;
+        if (root_bits <= 32)
+            return small_root(a, k);
+
+        // The root of the leading bits, plus one, is above the root by less than 2^s; a step
+        // squares that error relative to the root, which leaves it below k, and the next one
+        // usually lands on the floor.
+        size_t s = root_bits / 2;
+        big_integer x = root(a >> (k * s), k) + 1;
+        x <<= s;
+        for (;;)
+        {
+            big_integer p = power(x, k - 1);
+            if (p * x <= a)
+                return x;
+            // a / p has about root_bits bits, so the leading root_bits + 64 bits of p are
+            // enough; rounding the quotient up keeps x above the root
+            size_t p_bits = p.bit_length();
+            size_t t = p_bits > root_bits + limbs::limb_bits ? p_bits - root_bits - limbs::limb_bits : 0;
+            big_integer y = x * (k - 1);
+            y += (a >> t) / (p >> t) + 1;
+            y /= k;
+            if (y >= x)
+                --x;
+            else
+                x.swap(y);
+        }
+    }
+
+    // a mod 2^n for a >= 0
+    static big_integer low_bits(big_integer const& a, size_t n)
+    {
+        size_t size = std::min(a.mag.size(), (n + limbs::limb_bits - 1) / limbs::limb_bits);
+        big_integer r;
+        r.mag.assign(a.mag.begin(), a.mag.begin() + size);
+        if (size * limbs::limb_bits > n)
+            r.mag.back() &= limbs::limb_max >> (size * limbs::limb_bits - n);
+        r.normalize();
+        return r;
+    }
+
+    // s = floor(sqrt(a)) and r = a - s^2 for a > 0 by Zimmermann's recursive square root.
+    // With the m bits of the root split as h + l, l <= h, the root and remainder s', r' of
+    // the top 2h bits give the next l bits of the root as the quotient of r' 2^l plus the
+    // next l bits of a by 2 s', off by at most one; the cost is one such division and one
+    // square of l bits per level.
+    static void sqrtrem(big_integer const& a, big_integer& s, big_integer& r)
+    {
+        size_t m = (a.bit_length() + 1) / 2;
+        if (m <= 32)
+        {
+            s = small_root(a, 2);
+            r = a - s * s;
+            return;
+        }
+
+        size_t l = m / 2;
+        sqrtrem(a >> (2 * l), s, r);
+
+        r <<= l;
+        r += low_bits(a >> l, l);
+        big_integer q;
+        s <<= 1;
+        big_integer::divide(r, s.view(), &q, &r);
+        s >>= 1;
+        s <<= l;
+        s += q;
+        r <<= l;
+        r += low_bits(a, l);
+        r.submul(q, q);
+        if (r < 0)
+        {
+            --s;
+            r += s;
+            r += s;
+            ++r;
+        }
+    }
+};
+
+big_integer isqrt(big_integer const& a)
+{
+    if (a < 0)
+        throw std::runtime_error("even root of a negative number");
+    if (a == 0)
+        return 0;
+    big_integer s, r;
+    big_integer_root::sqrtrem(a, s, r);
+    return s;
+}
+
+big_integer iroot(big_integer const& a, uint64_t k)
+{
+    if (k == 0)
+        throw std::runtime_error("root of degree zero");
+    if (a < 0 && k % 2 == 0)
+        throw std::runtime_error("even root of a negative number");
+    if (k == 1 || a == 0)
+        return a;
+    if (k == 2)
+        return isqrt(a);
+    big_integer r = big_integer_root::root(a < 0 ? -a : a, k);
+    return a < 0 ? -std::move(r) : r;
+}
+
+bool is_perfect_square(big_integer const& a)
+{
+    if (a.negative)
+        return false;
+    if (a.mag.empty())
+        return true;
+    limb_t m = limbs::mod_1(a.mag.data(), a.mag.size(), 63 * 65 * 11);
+    if ((square_residues_64 >> (a.mag[0] % 64) & 1) == 0 || (square_residues_63 >> (m % 63) & 1) == 0
+        || (square_residues_65 >> (m % 65) & 1) == 0 || (square_residues_11 >> (m % 11) & 1) == 0)
+        return false;
+    big_integer s, r;
+    big_integer_root::sqrtrem(a, s, r);
+    return r == 0;
+}
+
+big_integer product(std::vector<big_integer> values)
+{
+    if (values.empty())
+        return 1;
+    for (big_integer const& v : values)
+        if (v == 0)
+            return 0;
+    // each pass multiplies neighbours into the left one and packs the results to the front,
+    // so the buffers of the left operands carry over to the next level
+    for (size_t n = values.size(); n > 1; n = (n + 1) / 2)
+    {
+        for (size_t i = 0; i != n / 2; ++i)
+        {
+            values[2 * i] *= values[2 * i + 1];
+            if (i != 0)
+                values[i].swap(values[2 * i]);
+        }
+        if (n % 2 == 1)
+            values[n / 2].swap(values[n - 1]);
+    }
+    return std::move(values[0]);
+}
+
+big_integer_accumulator& big_integer_accumulator::operator+=(big_integer const& a)
+{
+    add(a, a.negative);
+    return *this;
+}
+
+big_integer_accumulator& big_integer_accumulator::operator-=(big_integer const& a)
+{
+    add(a, !a.negative);
     return *this;
 }
 
+void big_integer_accumulator::add(big_integer const& a, bool negative)
+{
+    std::vector<limbs::dlimb_t>& c = columns[negative];
+    if (c.size() < a.mag.size())
+        c.resize(a.mag.size());
+    for (size_t i = 0; i != a.mag.size(); ++i)
+        c[i] += a.mag[i];
+}
+
+big_integer big_integer_accumulator::value() const
+{
+    size_t n = std::max(columns[0].size(), columns[1].size());
+    // the carry out of the top column is below the number of terms, so two limbs hold it
+    big_integer::storage_t totals[2];
+    for (size_t s = 0; s != 2; ++s)
+    {
+        totals[s].resize(n + 2);
+        limbs::dlimb_t carry = 0;
+        for (size_t i = 0; i != columns[s].size(); ++i)
+        {
+            carry += columns[s][i];
+            totals[s][i] = static_cast<limb_t>(carry);
+            carry >>= limbs::limb_bits;
+        }
+        totals[s][columns[s].size()] = static_cast<limb_t>(carry);
+        totals[s][columns[s].size() + 1] = static_cast<limb_t>(carry >> limbs::limb_bits);
+    }
+
+    big_integer r;
+    r.mag.swap(totals[0]);
+    if (limbs::cmp(r.mag.data(), totals[1].data(), n + 2) < 0)
+    {
+        r.mag.swap(totals[1]);
+        r.negative = true;
+    }
+    limbs::sub_n(r.mag.data(), r.mag.data(), totals[1].data(), n + 2);
+    r.normalize();
+    return r;
+}
+
+// The operators act on infinite two's complement without building it: a negative x is
+// ~(|x| - 1) there, so each operand is decremented on the fly and complemented by its
+// sign mask, and a negative result ~m is turned back into the magnitude m + 1, all in
+// the same pass over the limbs of *this.
+template <typename BitOp>
+void big_integer::bitwise(operand rhs, BitOp op)
+{
+    invalidate_hash();
+    limb_t const a_mask = negative ? limbs::limb_max : 0;
+    limb_t const b_mask = rhs.negative ? limbs::limb_max : 0;
+    limb_t const r_mask = op(a_mask, b_mask);
+    size_t an = mag.size();
+    size_t bn = rhs.size;
+
+    // past the shorter operand its sign extension may decide every limb, as x & 0 or x | ~0,
+    // and those limbs of the magnitude are all zero
+    size_t n = std::max(an, bn);
+    limb_t extension = an < bn ? a_mask : b_mask;
+    if (op(limb_t(0), extension) == op(limbs::limb_max, extension))
+        n = std::min(an, bn);
+    mag.resize(n);
+
+    limb_t a_borrow = a_mask & 1;
+    limb_t b_borrow = b_mask & 1;
+    limb_t carry = r_mask & 1;
+    size_t i = 0;
+    for (; i != n && (a_borrow | b_borrow | carry) != 0; ++i)
+    {
+        limb_t x = mag[i];
+        limb_t y = i < bn ? rhs.data[i] : 0;
+        limb_t xd = x - a_borrow;
+        a_borrow = x < a_borrow;
+        limb_t yd = y - b_borrow;
+        b_borrow = y < b_borrow;
+        limb_t z = (op(xd ^ a_mask, yd ^ b_mask) ^ r_mask) + carry;
+        carry = z < carry;
+        mag[i] = z;
+    }
+    // the borrows and the carry die out at the first nonzero limb, the rest is plain logic
+    for (size_t m = std::min(n, bn); i < m; ++i)
+        mag[i] = op(mag[i] ^ a_mask, rhs.data[i] ^ b_mask) ^ r_mask;
+    for (; i < n; ++i)
+        mag[i] = op(mag[i] ^ a_mask, b_mask) ^ r_mask;
+    if (carry != 0)
+        mag.push_back(carry);
+    negative = r_mask != 0;
+    normalize();
+}
+
+void big_integer::bitwise_and(operand rhs)
+{
+    bitwise(rhs, [](limb_t x, limb_t y) { return x & y; });
+}
+
+void big_integer::bitwise_or(operand rhs)
+{
+    bitwise(rhs, [](limb_t x, limb_t y) { return x | y; });
+}
+
+void big_integer::bitwise_xor(operand rhs)
+{
+    bitwise(rhs, [](limb_t x, limb_t y) { return x ^ y; });
+}
+
 big_integer& big_integer::operator&=(big_integer const& rhs)
 {
-    mpz_and(mpz, mpz, rhs.mpz);
+    bitwise_and(rhs.view());
     return *this;
 }
 
 big_integer& big_integer::operator|=(big_integer const& rhs)
 {
-    mpz_ior(mpz, mpz, rhs.mpz);
+    bitwise_or(rhs.view());
     return *this;
 }
 
 big_integer& big_integer::operator^=(big_integer const& rhs)
 {
-    mpz_xor(mpz, mpz, rhs.mpz);
+    bitwise_xor(rhs.view());
     return *this;
 }
 
-big_integer& big_integer::operator<<=(int rhs)
+// Both shifts move whole limbs and shift the bits within a limb in the same pass
+// (limbs::lshift and rshift funnel two neighbouring limbs), in the existing buffer.
+void big_integer::shift_left(uint64_t bits)
 {
-    mpz_mul_2exp(mpz, mpz, rhs);
-    return *this;
+    invalidate_hash();
+    if (mag.empty() || bits == 0)
+        return;
+
+    size_t whole = static_cast<size_t>(bits / limbs::limb_bits);
+    unsigned rest = static_cast<unsigned>(bits % limbs::limb_bits);
+    size_t n = mag.size();
+    if (whole > mag.max_size() - n - 1)
+        throw std::length_error("big_integer shift too large");
+
+    mag.resize(n + whole + (rest != 0 ? 1 : 0));
+    limb_t* data = mag.data();
+    if (rest != 0)
+        data[n + whole] = limbs::lshift(data + whole, data, n, rest);
+    else
+        std::copy_backward(data, data + n, data + n + whole);
+    std::fill(data, data + whole, limb_t(0));
+    normalize();
 }
 
-big_integer& big_integer::operator>>=(int rhs)
+void big_integer::shift_right(uint64_t bits)
 {
-    mpz_div_2exp(mpz, mpz, rhs);
-    return *this;
+    invalidate_hash();
+    if (mag.empty() || bits == 0)
+        return;
+
+    size_t n = mag.size();
+    if (bits / limbs::limb_bits >= n)
+    {
+        // everything is shifted out: 0, or -1 for a negative value
+        mag.resize(negative ? 1 : 0);
+        if (negative)
+            mag[0] = 1;
+        return;
+    }
+
+    size_t whole = static_cast<size_t>(bits / limbs::limb_bits);
+    unsigned rest = static_cast<unsigned>(bits % limbs::limb_bits);
+    limb_t* data = mag.data();
+    // a negative value rounds toward -inf, so any nonzero bit shifted out bumps the magnitude
+    bool lost = negative
+                && (std::any_of(data, data + whole, [](limb_t x) { return x != 0; })
+                    || (rest != 0 && (data[whole] << (limbs::limb_bits - rest)) != 0));
+
+    n -= whole;
+    if (rest != 0)
+        limbs::rshift(data, data + whole, n, rest);
+    else
+        std::copy(data + whole, data + whole + n, data);
+    // only a whole-limb shift can carry out of the top limb, and it freed a limb for the carry
+    limb_t carry = lost ? limbs::add_1(data, data, n, 1) : 0;
+    if (carry != 0)
+        data[n] = carry;
+    mag.resize(n + (carry != 0 ? 1 : 0));
+    normalize();
 }
 
 big_integer big_integer::operator+() const
@@ -103,24 +1566,43 @@ big_integer big_integer::operator+() const
     return *this;
 }
 
-big_integer big_integer::operator-() const
+big_integer big_integer::operator-() const&
 {
-    big_integer r;
-    mpz_neg(r.mpz, mpz);
-    return r;
+    big_integer r = *this;
+    return -std::move(r);
+}
+
+big_integer big_integer::operator-() &&
+{
+    invalidate_hash();
+    if (!mag.empty())
+        negative = !negative;
+    return std::move(*this);
 }
 
 big_integer big_integer::operator~() const
 {
+    // ~x = -x - 1, one pass from the magnitude of x
     big_integer r;
-    mpz_com(r.mpz, mpz);
+    size_t n = mag.size();
+    r.mag.resize(n);
+    if (negative)
+    {
+        limbs::sub_1(r.mag.data(), mag.data(), n, 1);
+        r.normalize();
+    }
+    else
+    {
+        r.negative = true;
+        if (limbs::add_1(r.mag.data(), mag.data(), n, 1) != 0)
+            r.mag.push_back(1);
+    }
     return r;
 }
 
 big_integer& big_integer::operator++()
 {
-    mpz_add_ui(mpz, mpz, 1);
-    return *this;
+    return *this += 1;
 }
 
 big_integer big_integer::operator++(int)
@@ -132,8 +1614,7 @@ big_integer big_integer::operator++(int)
 
 big_integer& big_integer::operator--()
 {
-    mpz_sub_ui(mpz, mpz, 1);
-    return *this;
+    return *this -= 1;
 }
 
 big_integer big_integer::operator--(int)
@@ -145,94 +1626,165 @@ big_integer big_integer::operator--(int)
 
 big_integer operator+(big_integer a, big_integer const& b)
 {
-    return a += b;
+    a += b;
+    return a;
+}
+
+big_integer operator+(big_integer const& a, big_integer&& b)
+{
+    b += a;
+    return std::move(b);
 }
 
 big_integer operator-(big_integer a, big_integer const& b)
 {
-    return a -= b;
+    a -= b;
+    return a;
+}
+
+big_integer operator-(big_integer const& a, big_integer&& b)
+{
+    b -= a;
+    return -std::move(b);
 }
 
 big_integer operator*(big_integer a, big_integer const& b)
 {
-    return a *= b;
+    a *= b;
+    return a;
+}
+
+big_integer operator*(big_integer const& a, big_integer&& b)
+{
+    b *= a;
+    return std::move(b);
 }
 
 big_integer operator/(big_integer a, big_integer const& b)
 {
-    return a /= b;
+    a /= b;
+    return a;
 }
 
 big_integer operator%(big_integer a, big_integer const& b)
 {
-    return a %= b;
+    a %= b;
+    return a;
 }
 
 big_integer operator&(big_integer a, big_integer const& b)
 {
-    return a &= b;
+    a &= b;
+    return a;
+}
+
+big_integer operator&(big_integer const& a, big_integer&& b)
+{
+    b &= a;
+    return std::move(b);
 }
 
 big_integer operator|(big_integer a, big_integer const& b)
 {
-    return a |= b;
+    a |= b;
+    return a;
+}
+
+big_integer operator|(big_integer const& a, big_integer&& b)
+{
+    b |= a;
+    return std::move(b);
 }
 
 big_integer operator^(big_integer a, big_integer const& b)
 {
-    return a ^= b;
+    a ^= b;
+    return a;
+}
+
+big_integer operator^(big_integer const& a, big_integer&& b)
+{
+    b ^= a;
+    return std::move(b);
+}
+
+size_t big_integer::bit_length() const
+{
+    if (mag.empty())
+        return 0;
+    return mag.size() * limbs::limb_bits - limbs::count_leading_zeros(mag.back());
+}
+
+size_t big_integer::hash() const noexcept
+{
+#ifdef BIG_INTEGER_CACHED_HASH
+    if (hash_cache != 0)
+        return hash_cache;
+#endif
+    // the sign goes into the seed; 0 is kept free to mark an empty cache
+    limb_t h = limbs::hash(mag.data(), mag.size(), negative ? limbs::limb_max : 0);
+    h = h != 0 ? h : 1;
+#ifdef BIG_INTEGER_CACHED_HASH
+    hash_cache = static_cast<size_t>(h);
+#endif
+    return static_cast<size_t>(h);
 }
 
-big_integer operator<<(big_integer a, int b)
+int big_integer::compare(operand rhs) const
 {
-    return a <<= b;
+    if (negative != rhs.negative)
+        return negative ? -1 : 1;
+    int c = limbs::cmp(mag.data(), mag.size(), rhs.data, rhs.size);
+    return negative ? -c : c;
 }
 
-big_integer operator>>(big_integer a, int b)
+int big_integer::compare(big_integer const& rhs) const
 {
-    return a >>= b;
+    return compare(rhs.view());
 }
 
 bool operator==(big_integer const& a, big_integer const& b)
 {
-    return mpz_cmp(a.mpz, b.mpz) == 0;
+    return a.compare(b) == 0;
 }
 
 bool operator!=(big_integer const& a, big_integer const& b)
 {
-    return mpz_cmp(a.mpz, b.mpz) != 0;
+    return a.compare(b) != 0;
 }
 
 bool operator<(big_integer const& a, big_integer const& b)
 {
-    return mpz_cmp(a.mpz, b.mpz) < 0;
+    return a.compare(b) < 0;
 }
 
 bool operator>(big_integer const& a, big_integer const& b)
 {
-    return mpz_cmp(a.mpz, b.mpz) > 0;
+    return a.compare(b) > 0;
 }
 
 bool operator<=(big_integer const& a, big_integer const& b)
 {
-    return mpz_cmp(a.mpz, b.mpz) <= 0;
+    return a.compare(b) <= 0;
 }
 
 bool operator>=(big_integer const& a, big_integer const& b)
 {
-    return mpz_cmp(a.mpz, b.mpz) >= 0;
+    return a.compare(b) >= 0;
 }
 
 std::string to_string(big_integer const& a)
 {
-    char* tmp = mpz_get_str(NULL, 10, a.mpz);
-    std::string res = tmp;
-
-    void (*freefunc)(void*, size_t);
-    mp_get_memory_functions (NULL, NULL, &freefunc);
-
-    freefunc(tmp, strlen(tmp) + 1);
+    if (a.mag.empty())
+        return "0";
 
+    // |a| < 2^bits <= 10^(bits log10(2)), the extra digit absorbs rounding
+    size_t digits = static_cast<size_t>(static_cast<double>(a.bit_length()) * 0.30102999566398120) + 2;
+    size_t sign = a.negative ? 1 : 0;
+    std::string res(sign + digits, '-');
+    storage_t tmp = a.mag;
+    write_decimal(&res[sign], digits, tmp.data(), tmp.size(), decimal_powers(digits));
+    res.erase(sign, res.find_first_not_of('0', sign) - sign);
     return res;
 }
 
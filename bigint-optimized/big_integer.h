@@ -2,18 +2,80 @@
 #define BIG_INTEGER_H
 
 #include <cstddef>
-#include <gmp.h>
+#include <cstdint>
+#include <functional>
 #include <iosfwd>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "limb_storage.h"
+
+struct big_integer_reciprocal;
+struct montgomery_context;
+struct big_integer_gcd;
+struct big_integer_root;
+struct big_integer_accumulator;
+struct big_integer_fixed_conversion;
+
+// A constant integer over limbs it does not own, in the form big_integer keeps: |value| in
+// size limbs, least significant first, without leading zero limbs, and zero is never negative.
+// A _bi literal is one, made at no cost; a big_integer made from it copies the limbs, while
+// operators and comparisons with a big_integer on their left take it as it is. The limbs must
+// outlive the view.
+struct big_integer_view
+{
+    bool negative;
+    uint64_t const* data;
+    size_t size;
+
+    constexpr big_integer_view operator-() const
+    {
+        return big_integer_view{!negative && size != 0, data, size};
+    }
+};
 
 struct big_integer
 {
+    typedef uint64_t limb_t;
+    typedef limb_storage storage_t;
+    __extension__ typedef __int128 int128_t;
+    __extension__ typedef unsigned __int128 uint128_t;
+
+    // Built-in integers up to 128 bits (bool aside), which mixed-width constructors, operators and
+    // comparisons take directly: they run single-limb kernels without building a temporary big_integer.
+    template <typename T>
+    struct is_machine_integer
+        : std::integral_constant<bool, (std::is_integral<T>::value && !std::is_same<T, bool>::value)
+                                           || std::is_same<T, int128_t>::value || std::is_same<T, uint128_t>::value>
+    {};
+    template <typename T>
+    using if_machine_integer = typename std::enable_if<is_machine_integer<T>::value, int>::type;
+    // the constructor and the operators with a big_integer on their left take views as well;
+    // with a view on the left of an operator, it converts to a big_integer first
+    template <typename T>
+    using if_operand =
+        typename std::enable_if<is_machine_integer<T>::value || std::is_same<T, big_integer_view>::value, int>::type;
+
     big_integer();
     big_integer(big_integer const& other);
+    // leaves other equal to zero
+    big_integer(big_integer&& other) noexcept;
     big_integer(int a);
-    explicit big_integer(std::string const& str);
+    template <typename T, if_operand<T> = 0>
+    big_integer(T a);
+    // optional '-' followed by decimal digits, throws std::runtime_error otherwise
+    explicit big_integer(std::string_view str);
+    big_integer(char const* str, size_t len);
     ~big_integer();
 
     big_integer& operator=(big_integer const& other);
+    big_integer& operator=(big_integer&& other) noexcept;
+
+    void swap(big_integer& other) noexcept;
 
     big_integer& operator+=(big_integer const& rhs);
     big_integer& operator-=(big_integer const& rhs);
@@ -21,15 +83,42 @@ struct big_integer
     big_integer& operator/=(big_integer const& rhs);
     big_integer& operator%=(big_integer const& rhs);
 
+    template <typename T, if_operand<T> = 0>
+    big_integer& operator+=(T rhs);
+    template <typename T, if_operand<T> = 0>
+    big_integer& operator-=(T rhs);
+    template <typename T, if_operand<T> = 0>
+    big_integer& operator*=(T rhs);
+    template <typename T, if_operand<T> = 0>
+    big_integer& operator/=(T rhs);
+    template <typename T, if_operand<T> = 0>
+    big_integer& operator%=(T rhs);
+
+    // *this += y * z and *this -= y * z without a temporary for the product
+    big_integer& addmul(big_integer const& y, big_integer const& z);
+    big_integer& submul(big_integer const& y, big_integer const& z);
+
     big_integer& operator&=(big_integer const& rhs);
     big_integer& operator|=(big_integer const& rhs);
     big_integer& operator^=(big_integer const& rhs);
 
-    big_integer& operator<<=(int rhs);
-    big_integer& operator>>=(int rhs);
+    template <typename T, if_operand<T> = 0>
+    big_integer& operator&=(T rhs);
+    template <typename T, if_operand<T> = 0>
+    big_integer& operator|=(T rhs);
+    template <typename T, if_operand<T> = 0>
+    big_integer& operator^=(T rhs);
+
+    // shift counts are in bits, a negative count shifts the other way; every built-in integer
+    // is taken at its own width, and the count is bounded by memory rather than by int
+    template <typename T, if_machine_integer<T> = 0>
+    big_integer& operator<<=(T rhs);
+    template <typename T, if_machine_integer<T> = 0>
+    big_integer& operator>>=(T rhs);
 
     big_integer operator+() const;
-    big_integer operator-() const;
+    big_integer operator-() const&;
+    big_integer operator-() &&;
     big_integer operator~() const;
 
     big_integer& operator++();
@@ -45,24 +134,267 @@ struct big_integer
     friend bool operator<=(big_integer const& a, big_integer const& b);
     friend bool operator>=(big_integer const& a, big_integer const& b);
 
+    template <typename T, if_operand<T> = 0>
+    friend bool operator==(big_integer const& a, T b) { return a.compare(b) == 0; }
+    template <typename T, if_operand<T> = 0>
+    friend bool operator!=(big_integer const& a, T b) { return a.compare(b) != 0; }
+    template <typename T, if_operand<T> = 0>
+    friend bool operator<(big_integer const& a, T b) { return a.compare(b) < 0; }
+    template <typename T, if_operand<T> = 0>
+    friend bool operator>(big_integer const& a, T b) { return a.compare(b) > 0; }
+    template <typename T, if_operand<T> = 0>
+    friend bool operator<=(big_integer const& a, T b) { return a.compare(b) <= 0; }
+    template <typename T, if_operand<T> = 0>
+    friend bool operator>=(big_integer const& a, T b) { return a.compare(b) >= 0; }
+
+    template <typename T, if_machine_integer<T> = 0>
+    friend bool operator==(T a, big_integer const& b) { return b.compare(a) == 0; }
+    template <typename T, if_machine_integer<T> = 0>
+    friend bool operator!=(T a, big_integer const& b) { return b.compare(a) != 0; }
+    template <typename T, if_machine_integer<T> = 0>
+    friend bool operator<(T a, big_integer const& b) { return b.compare(a) > 0; }
+    template <typename T, if_machine_integer<T> = 0>
+    friend bool operator>(T a, big_integer const& b) { return b.compare(a) < 0; }
+    template <typename T, if_machine_integer<T> = 0>
+    friend bool operator<=(T a, big_integer const& b) { return b.compare(a) >= 0; }
+    template <typename T, if_machine_integer<T> = 0>
+    friend bool operator>=(T a, big_integer const& b) { return b.compare(a) <= 0; }
+
+    friend std::pair<big_integer, big_integer> divmod(big_integer const& a, big_integer const& b);
+    friend std::pair<big_integer, big_integer> divmod(big_integer const& a, big_integer_reciprocal const& b);
     friend std::string to_string(big_integer const& a);
 
+    // hash of the value, equal values hash alike; what std::hash<big_integer> returns.
+    // With BIG_INTEGER_CACHED_HASH defined it is computed once per value and kept until
+    // the next mutation.
+    size_t hash() const noexcept;
+
+private:
+    // Sign and magnitude of the right-hand side of an operation: a view of a big_integer or of
+    // a literal, or a machine integer spread over at most two limbs of caller storage.
+    typedef big_integer_view operand;
+
+    operand view() const;
+    template <typename T>
+    static operand make_operand(T a, limb_t (&buffer)[2]);
+    static operand make_operand(big_integer_view a, limb_t (&buffer)[2]);
+    void assign(operand a);
+
+    void add(operand rhs);
+    void subtract(operand rhs);
+    // |this| += |rhs| and |this| -= |rhs| with the sign of the result fixed up
+    void add_magnitude(operand rhs);
+    void sub_magnitude(operand rhs);
+    void multiply(operand rhs);
+    void multiply_accumulate(big_integer const& y, big_integer const& z, bool subtract);
+    // either output may be null or alias an operand
+    static void divide(big_integer const& a, operand b, big_integer* quotient, big_integer* remainder);
+
+    // |a| as a bit count, saturated at 2^64 - 1: no left shift that far fits in memory,
+    // and a right shift that far already clears every bit
+    template <typename T>
+    static constexpr uint64_t shift_count(T a);
+    // in place, a right shift of a negative value rounds toward -inf
+    void shift_left(uint64_t bits);
+    void shift_right(uint64_t bits);
+
+    template <typename BitOp>
+    void bitwise(operand rhs, BitOp op);
+    void bitwise_and(operand rhs);
+    void bitwise_or(operand rhs);
+    void bitwise_xor(operand rhs);
+
+    void normalize();
+
+    int compare(operand rhs) const;
+    int compare(big_integer const& rhs) const;
+    template <typename T>
+    int compare(T rhs) const;
+    size_t bit_length() const;
+
+    // every mutation goes through one of the primitives above, which call this first
+    void invalidate_hash();
+
+    friend struct big_integer_reciprocal;
+    friend struct montgomery_context;
+    friend big_integer powmod(big_integer const& base, big_integer const& exp, big_integer const& mod);
+    friend struct big_integer_gcd;
+    friend big_integer gcd(big_integer const& a, big_integer const& b);
+    friend std::tuple<big_integer, big_integer, big_integer> gcdext(big_integer const& a, big_integer const& b);
+    friend struct big_integer_root;
+    friend bool is_perfect_square(big_integer const& a);
+    friend struct big_integer_accumulator;
+    friend struct big_integer_fixed_conversion;
+
 private:
-    mpz_t mpz;
+    // sign-magnitude: mag holds |value| without leading zero limbs, zero is never negative
+    bool negative;
+    storage_t mag;
+#ifdef BIG_INTEGER_CACHED_HASH
+    // hash() of the current value, 0 until computed. Computing it writes here, so in this
+    // mode one big_integer must not be hashed from several threads at once.
+    mutable size_t hash_cache = 0;
+#endif
 };
 
+#ifndef BIG_INTEGER_CACHED_HASH
+static_assert(sizeof(big_integer) == 32, "small values are meant to fit in 32 bytes with their limbs");
+#endif
+
+inline void big_integer::invalidate_hash()
+{
+#ifdef BIG_INTEGER_CACHED_HASH
+    hash_cache = 0;
+#endif
+}
+
+// The left operand is taken by value, so a temporary lends its buffer to the result;
+// the overloads taking the right operand by rvalue reference reuse that one instead.
 big_integer operator+(big_integer a, big_integer const& b);
+big_integer operator+(big_integer const& a, big_integer&& b);
 big_integer operator-(big_integer a, big_integer const& b);
+big_integer operator-(big_integer const& a, big_integer&& b);
+#ifndef BIG_INTEGER_EXPRESSION_TEMPLATES
 big_integer operator*(big_integer a, big_integer const& b);
+big_integer operator*(big_integer const& a, big_integer&& b);
+#endif
 big_integer operator/(big_integer a, big_integer const& b);
 big_integer operator%(big_integer a, big_integer const& b);
 
 big_integer operator&(big_integer a, big_integer const& b);
+big_integer operator&(big_integer const& a, big_integer&& b);
 big_integer operator|(big_integer a, big_integer const& b);
+big_integer operator|(big_integer const& a, big_integer&& b);
 big_integer operator^(big_integer a, big_integer const& b);
+big_integer operator^(big_integer const& a, big_integer&& b);
 
-big_integer operator<<(big_integer a, int b);
-big_integer operator>>(big_integer a, int b);
+template <typename T, big_integer::if_machine_integer<T> = 0>
+big_integer operator<<(big_integer a, T b)
+{
+    a <<= b;
+    return a;
+}
+
+template <typename T, big_integer::if_machine_integer<T> = 0>
+big_integer operator>>(big_integer a, T b)
+{
+    a >>= b;
+    return a;
+}
+
+template <typename T, big_integer::if_operand<T> = 0>
+big_integer operator+(big_integer a, T b)
+{
+    a += b;
+    return a;
+}
+
+template <typename T, big_integer::if_machine_integer<T> = 0>
+big_integer operator+(T a, big_integer b)
+{
+    b += a;
+    return b;
+}
+
+template <typename T, big_integer::if_operand<T> = 0>
+big_integer operator-(big_integer a, T b)
+{
+    a -= b;
+    return a;
+}
+
+template <typename T, big_integer::if_machine_integer<T> = 0>
+big_integer operator-(T a, big_integer b)
+{
+    b -= a;
+    return -std::move(b);
+}
+
+template <typename T, big_integer::if_operand<T> = 0>
+big_integer operator*(big_integer a, T b)
+{
+    a *= b;
+    return a;
+}
+
+template <typename T, big_integer::if_machine_integer<T> = 0>
+big_integer operator*(T a, big_integer b)
+{
+    b *= a;
+    return b;
+}
+
+template <typename T, big_integer::if_operand<T> = 0>
+big_integer operator/(big_integer a, T b)
+{
+    a /= b;
+    return a;
+}
+
+template <typename T, big_integer::if_machine_integer<T> = 0>
+big_integer operator/(T a, big_integer const& b)
+{
+    big_integer r(a);
+    r /= b;
+    return r;
+}
+
+template <typename T, big_integer::if_operand<T> = 0>
+big_integer operator%(big_integer a, T b)
+{
+    a %= b;
+    return a;
+}
+
+template <typename T, big_integer::if_machine_integer<T> = 0>
+big_integer operator%(T a, big_integer const& b)
+{
+    big_integer r(a);
+    r %= b;
+    return r;
+}
+
+template <typename T, big_integer::if_operand<T> = 0>
+big_integer operator&(big_integer a, T b)
+{
+    a &= b;
+    return a;
+}
+
+template <typename T, big_integer::if_machine_integer<T> = 0>
+big_integer operator&(T a, big_integer b)
+{
+    b &= a;
+    return b;
+}
+
+template <typename T, big_integer::if_operand<T> = 0>
+big_integer operator|(big_integer a, T b)
+{
+    a |= b;
+    return a;
+}
+
+template <typename T, big_integer::if_machine_integer<T> = 0>
+big_integer operator|(T a, big_integer b)
+{
+    b |= a;
+    return b;
+}
+
+template <typename T, big_integer::if_operand<T> = 0>
+big_integer operator^(big_integer a, T b)
+{
+    a ^= b;
+    return a;
+}
+
+template <typename T, big_integer::if_machine_integer<T> = 0>
+big_integer operator^(T a, big_integer b)
+{
+    b ^= a;
+    return b;
+}
 
 bool operator==(big_integer const& a, big_integer const& b);
 bool operator!=(big_integer const& a, big_integer const& b);
@@ -71,7 +403,430 @@ bool operator>(big_integer const& a, big_integer const& b);
 bool operator<=(big_integer const& a, big_integer const& b);
 bool operator>=(big_integer const& a, big_integer const& b);
 
+// truncated quotient and remainder computed in one pass
+std::pair<big_integer, big_integer> divmod(big_integer const& a, big_integer const& b);
+
+// Fixed-point inverse of a divisor computed by Newton iteration, so that dividing by it
+// costs two multiplications per divisor-sized block of the dividend. Division by a large
+// enough divisor builds one internally; keep one around to divide many values by the same number.
+struct big_integer_reciprocal
+{
+    explicit big_integer_reciprocal(big_integer const& divisor);
+
+    friend std::pair<big_integer, big_integer> divmod(big_integer const& a, big_integer_reciprocal const& b);
+
+private:
+    bool negative;
+    big_integer magnitude;
+    size_t bits;
+    // floor(2^(2 bits) / magnitude)
+    big_integer inverse;
+};
+
+std::pair<big_integer, big_integer> divmod(big_integer const& a, big_integer_reciprocal const& b);
+
+// Arithmetic modulo a fixed odd modulus m > 1 in Montgomery form, x R mod m with R = B^n
+// for the n limbs of m, where a product is reduced by REDC instead of a division. powmod
+// builds one per call; keep one around for many exponentiations modulo the same number.
+struct montgomery_context
+{
+    // throws std::runtime_error unless |modulus| is odd and greater than 1
+    explicit montgomery_context(big_integer const& modulus);
+
+    big_integer const& modulus() const;
+
+    // x mod m of any x into Montgomery form, and back to [0, m)
+    big_integer to_montgomery(big_integer const& x) const;
+    big_integer from_montgomery(big_integer const& x) const;
+    // a b R^-1 mod m for a and b in Montgomery form
+    big_integer multiply(big_integer const& a, big_integer const& b) const;
+
+    // base^exp mod m in [0, m) for any base and exp >= 0, by sliding windows;
+    // throws std::runtime_error for a negative exponent
+    big_integer pow(big_integer const& base, big_integer const& exp) const;
+
+private:
+    big_integer m;
+    // -m^-1 mod B
+    big_integer::limb_t minv;
+    // R^2 mod m, which takes a residue into Montgomery form in one product
+    big_integer r2;
+};
+
+// base^exp mod |mod| in [0, |mod|) for exp >= 0: Montgomery multiplication for an odd modulus,
+// Barrett reduction for an even one. Throws std::runtime_error for a zero modulus or a
+// negative exponent.
+big_integer powmod(big_integer const& base, big_integer const& exp, big_integer const& mod);
+
+// Greatest common divisor, always nonnegative, gcd(0, 0) == 0. Lehmer's algorithm batches
+// the quotients of Euclid's algorithm found from the leading two limbs into one pass over the
+// operands; above limbs::gcd_threshold limbs the leading half of the operands is reduced
+// recursively (half-gcd), which brings the cost down to a logarithmic factor over a product.
+big_integer gcd(big_integer const& a, big_integer const& b);
+// least common multiple, nonnegative, 0 if a or b is 0
+big_integer lcm(big_integer const& a, big_integer const& b);
+// (g, s, t) with g = gcd(a, b) = s a + t b. For b != 0, |s| <= |b| / 2g;
+// for b == 0, s is the sign of a and t is 0.
+std::tuple<big_integer, big_integer, big_integer> gcdext(big_integer const& a, big_integer const& b);
+// x in [0, |m|) with a x == 1 mod m; throws std::runtime_error for m == 0 or gcd(a, m) != 1
+big_integer modinv(big_integer const& a, big_integer const& m);
+
+// floor(sqrt(a)) and the k-th root rounded toward zero, at doubling precision: the root of
+// the leading half of the digits seeds one step at full precision (Zimmermann's square root
+// with its remainder, a Newton step for k > 2), so the whole costs a few multiplications of
+// the full size. Throw std::runtime_error for an even root of a negative number and for k == 0.
+big_integer isqrt(big_integer const& a);
+big_integer iroot(big_integer const& a, uint64_t k);
+// whether a == r * r for some r; most non-squares are rejected by their residues
+// modulo 64, 63, 65 and 11 without a root
+bool is_perfect_square(big_integer const& a);
+
+// the product of the values, multiplied pairwise in a balanced tree so the fast multiplication
+// tiers see operands of equal size instead of one growing accumulator; product of none is 1
+big_integer product(std::vector<big_integer> values);
+
+template <typename InputIt>
+big_integer product(InputIt first, InputIt last)
+{
+    return product(std::vector<big_integer>(first, last));
+}
+
+// A running sum of many values. Their limbs are added into 128-bit columns, one set for each
+// sign, without carries, which value() propagates once; a column takes 2^64 terms before it
+// can overflow. The cost is one pass over the limbs of the terms, where += on a big_integer
+// goes over the whole accumulator for each of them.
+struct big_integer_accumulator
+{
+    big_integer_accumulator& operator+=(big_integer const& a);
+    big_integer_accumulator& operator-=(big_integer const& a);
+
+    big_integer value() const;
+
+private:
+    void add(big_integer const& a, bool negative);
+
+    std::vector<big_integer::uint128_t> columns[2];
+};
+
+// the sum of the values through big_integer_accumulator; sum of none is 0
+template <typename InputIt>
+big_integer sum(InputIt first, InputIt last)
+{
+    big_integer_accumulator r;
+    for (; first != last; ++first)
+        r += *first;
+    return r.value();
+}
+
+void swap(big_integer& a, big_integer& b) noexcept;
+
 std::string to_string(big_integer const& a);
 std::ostream& operator<<(std::ostream& s, big_integer const& a);
 
+// The limbs of an integer literal, computed at compile time into static storage: decimal,
+// 0x hexadecimal, 0b binary or 0 octal, with ' separators, as in C++.
+template <char... Digits>
+struct big_integer_literal
+{
+    // four bits per digit bound every base up to 16
+    static constexpr size_t capacity = sizeof...(Digits) * 4 / 64 + 1;
+
+    struct parsed
+    {
+        big_integer::limb_t limbs[capacity];
+        size_t size;
+        bool valid;
+    };
+
+    static constexpr parsed parse()
+    {
+        char const digits[] = {Digits...};
+        size_t n = sizeof...(Digits);
+        size_t i = 0;
+        unsigned base = 10;
+        if (n > 1 && digits[0] == '0')
+        {
+            char prefix = digits[1] | 0x20;
+            base = prefix == 'x' ? 16 : prefix == 'b' ? 2 : 8;
+            i = base == 8 ? 1 : 2;
+        }
+        parsed r{};
+        r.valid = i != n;
+        for (; i != n; ++i)
+        {
+            char c = digits[i];
+            if (c == '\'')
+                continue;
+            char lower = c | 0x20;
+            unsigned d = c >= '0' && c <= '9' ? c - '0' : lower >= 'a' && lower <= 'f' ? lower - 'a' + 10 : base;
+            if (d >= base)
+            {
+                r.valid = false;
+                return r;
+            }
+            // r = r * base + d
+            big_integer::limb_t carry = d;
+            for (size_t j = 0; j != r.size; ++j)
+            {
+                big_integer::uint128_t t = big_integer::uint128_t(r.limbs[j]) * base + carry;
+                r.limbs[j] = static_cast<big_integer::limb_t>(t);
+                carry = static_cast<big_integer::limb_t>(t >> 64);
+            }
+            if (carry != 0)
+                r.limbs[r.size++] = carry;
+        }
+        return r;
+    }
+
+    static constexpr parsed value = parse();
+    static_assert(value.valid, "_bi takes an integer literal");
+};
+
+// 147573952589676412928_bi is a big_integer_view of limbs parsed at compile time, so
+// binding it to a big_integer_view costs nothing and making a big_integer of it one copy;
+// -x_bi is negative
+template <char... Digits>
+constexpr big_integer_view operator""_bi()
+{
+    typedef big_integer_literal<Digits...> literal;
+    return big_integer_view{false, literal::value.limbs, literal::value.size};
+}
+
+namespace std
+{
+template <>
+struct hash<big_integer>
+{
+    size_t operator()(big_integer const& a) const noexcept
+    {
+        return a.hash();
+    }
+};
+}
+
+template <typename T>
+big_integer::operand big_integer::make_operand(T a, limb_t (&buffer)[2])
+{
+    // the magnitude is taken modulo 2^128, which also covers the most negative value
+    bool negative = a < 0;
+    uint128_t m = static_cast<uint128_t>(a);
+    if (negative)
+        m = 0 - m;
+    buffer[0] = static_cast<limb_t>(m);
+    buffer[1] = static_cast<limb_t>(m >> 64);
+    return operand{negative, buffer, buffer[1] != 0 ? 2u : buffer[0] != 0 ? 1u : 0u};
+}
+
+inline big_integer::operand big_integer::make_operand(big_integer_view a, limb_t (&)[2])
+{
+    return a;
+}
+
+template <typename T, big_integer::if_operand<T>>
+big_integer::big_integer(T a)
+    : negative(false)
+{
+    limb_t buffer[2];
+    assign(make_operand(a, buffer));
+}
+
+template <typename T, big_integer::if_operand<T>>
+big_integer& big_integer::operator+=(T rhs)
+{
+    limb_t buffer[2];
+    add(make_operand(rhs, buffer));
+    return *this;
+}
+
+template <typename T, big_integer::if_operand<T>>
+big_integer& big_integer::operator-=(T rhs)
+{
+    limb_t buffer[2];
+    subtract(make_operand(rhs, buffer));
+    return *this;
+}
+
+template <typename T, big_integer::if_operand<T>>
+big_integer& big_integer::operator*=(T rhs)
+{
+    limb_t buffer[2];
+    multiply(make_operand(rhs, buffer));
+    return *this;
+}
+
+template <typename T, big_integer::if_operand<T>>
+big_integer& big_integer::operator/=(T rhs)
+{
+    limb_t buffer[2];
+    divide(*this, make_operand(rhs, buffer), this, nullptr);
+    return *this;
+}
+
+template <typename T, big_integer::if_operand<T>>
+big_integer& big_integer::operator%=(T rhs)
+{
+    limb_t buffer[2];
+    divide(*this, make_operand(rhs, buffer), nullptr, this);
+    return *this;
+}
+
+template <typename T>
+constexpr uint64_t big_integer::shift_count(T a)
+{
+    uint128_t m = static_cast<uint128_t>(a);
+    if (a < 0)
+        m = 0 - m;
+    return (m >> 64) != 0 ? UINT64_MAX : static_cast<uint64_t>(m);
+}
+
+template <typename T, big_integer::if_machine_integer<T>>
+big_integer& big_integer::operator<<=(T rhs)
+{
+    if (rhs < 0)
+        shift_right(shift_count(rhs));
+    else
+        shift_left(shift_count(rhs));
+    return *this;
+}
+
+template <typename T, big_integer::if_machine_integer<T>>
+big_integer& big_integer::operator>>=(T rhs)
+{
+    if (rhs < 0)
+        shift_left(shift_count(rhs));
+    else
+        shift_right(shift_count(rhs));
+    return *this;
+}
+
+template <typename T, big_integer::if_operand<T>>
+big_integer& big_integer::operator&=(T rhs)
+{
+    limb_t buffer[2];
+    bitwise_and(make_operand(rhs, buffer));
+    return *this;
+}
+
+template <typename T, big_integer::if_operand<T>>
+big_integer& big_integer::operator|=(T rhs)
+{
+    limb_t buffer[2];
+    bitwise_or(make_operand(rhs, buffer));
+    return *this;
+}
+
+template <typename T, big_integer::if_operand<T>>
+big_integer& big_integer::operator^=(T rhs)
+{
+    limb_t buffer[2];
+    bitwise_xor(make_operand(rhs, buffer));
+    return *this;
+}
+
+template <typename T>
+int big_integer::compare(T rhs) const
+{
+    limb_t buffer[2];
+    return compare(make_operand(rhs, buffer));
+}
+
+#ifdef BIG_INTEGER_EXPRESSION_TEMPLATES
+// Opt-in lazy products. With BIG_INTEGER_EXPRESSION_TEMPLATES defined before this header,
+// y * z is a big_integer_product that becomes a big_integer wherever a value is needed,
+// while x += y * z, x -= y * z and x = y * z + w run as a single addmul or submul.
+// A product refers to its operands, so it must not outlive the full expression
+// (do not bind one to auto).
+struct big_integer_product
+{
+    big_integer const& y;
+    big_integer const& z;
+
+    operator big_integer() const
+    {
+        big_integer r = y;
+        r *= z;
+        return r;
+    }
+
+    big_integer operator-() const
+    {
+        return -big_integer(*this);
+    }
+};
+
+// w + y * z or w - y * z, w is copied once on conversion
+struct big_integer_product_sum
+{
+    big_integer const& w;
+    big_integer_product p;
+    bool subtract;
+
+    operator big_integer() const
+    {
+        big_integer r = w;
+        if (subtract)
+            r.submul(p.y, p.z);
+        else
+            r.addmul(p.y, p.z);
+        return r;
+    }
+};
+
+inline big_integer_product operator*(big_integer const& y, big_integer const& z)
+{
+    return big_integer_product{y, z};
+}
+
+inline big_integer_product_sum operator+(big_integer_product p, big_integer const& w)
+{
+    return big_integer_product_sum{w, p, false};
+}
+
+inline big_integer_product_sum operator+(big_integer const& w, big_integer_product p)
+{
+    return big_integer_product_sum{w, p, false};
+}
+
+inline big_integer_product_sum operator-(big_integer const& w, big_integer_product p)
+{
+    return big_integer_product_sum{w, p, true};
+}
+
+// a temporary w (or an int) accumulates the product in its own buffer
+inline big_integer operator+(big_integer_product p, big_integer&& w)
+{
+    w.addmul(p.y, p.z);
+    return std::move(w);
+}
+
+inline big_integer operator+(big_integer&& w, big_integer_product p)
+{
+    w.addmul(p.y, p.z);
+    return std::move(w);
+}
+
+inline big_integer operator-(big_integer&& w, big_integer_product p)
+{
+    w.submul(p.y, p.z);
+    return std::move(w);
+}
+
+inline big_integer operator+(big_integer_product p, big_integer_product q)
+{
+    big_integer r = p;
+    r.addmul(q.y, q.z);
+    return r;
+}
+
+inline big_integer& operator+=(big_integer& x, big_integer_product p)
+{
+    return x.addmul(p.y, p.z);
+}
+
+inline big_integer& operator-=(big_integer& x, big_integer_product p)
+{
+    return x.submul(p.y, p.z);
+}
+#endif
+
 #endif // BIG_INTEGER_H
@@ -0,0 +1,172 @@
+#include "big_integer_arena.h"
+
+#include <algorithm>
+#include <cassert>
+#include <new>
+#ifndef BIG_INTEGER_SINGLE_THREADED
+#include <atomic>
+#endif
+
+namespace
+{
+size_t const first_chunk = 64 * 1024;
+size_t const max_chunk = 64 * 1024 * 1024;
+// bytes of chunks a thread keeps from ended arenas
+size_t const max_spare = 64 * 1024 * 1024;
+size_t const alignment = 8;
+
+thread_local big_integer_arena* innermost = nullptr;
+}
+
+// Every block of a chunk is preceded by a pointer to it. The chunk counts its blocks in use
+// plus one for its arena, and whoever drops the count to zero frees it.
+struct big_integer_arena::chunk
+{
+    chunk* previous;
+    size_t size;
+#ifdef BIG_INTEGER_SINGLE_THREADED
+    size_t users;
+#else
+    std::atomic<size_t> users;
+#endif
+};
+
+// the pages of a kept chunk are already mapped and likely cached when the next arena starts
+struct big_integer_arena::spare_chunks
+{
+    ~spare_chunks()
+    {
+        while (head != nullptr)
+        {
+            chunk* c = head;
+            head = c->previous;
+            ::operator delete(c);
+        }
+    }
+
+    chunk* head = nullptr;
+    size_t bytes = 0;
+};
+
+thread_local big_integer_arena::spare_chunks big_integer_arena::spare;
+
+big_integer_arena::chunk* big_integer_arena::take_spare(size_t size)
+{
+    for (chunk** p = &spare.head; *p != nullptr; p = &(*p)->previous)
+    {
+        chunk* c = *p;
+        if (c->size >= size)
+        {
+            *p = c->previous;
+            spare.bytes -= c->size;
+            return c;
+        }
+    }
+    return nullptr;
+}
+
+big_integer_arena::big_integer_arena()
+    : outer(innermost)
+    , level(innermost != nullptr ? innermost->level + 1 : 1)
+    , chunks(nullptr)
+    , next(nullptr)
+    , end(nullptr)
+    , total(0)
+{
+    innermost = this;
+}
+
+big_integer_arena::~big_integer_arena()
+{
+    assert(innermost == this);
+    innermost = outer;
+    while (chunks != nullptr)
+    {
+        chunk* c = chunks;
+        chunks = c->previous;
+#ifdef BIG_INTEGER_SINGLE_THREADED
+        bool unused = --c->users == 0;
+#else
+        bool unused = c->users.fetch_sub(1, std::memory_order_acq_rel) == 1;
+#endif
+        // a chunk with buffers still in use is freed by the last of them
+        if (!unused)
+            continue;
+        if (spare.bytes + c->size <= max_spare)
+        {
+            c->previous = spare.head;
+            spare.head = c;
+            spare.bytes += c->size;
+        }
+        else
+        {
+            ::operator delete(c);
+        }
+    }
+}
+
+big_integer big_integer_arena::keep(big_integer const& x)
+{
+    // a copy of arena limbs is made on the heap
+    return x;
+}
+
+big_integer_arena* big_integer_arena::current() noexcept
+{
+    return innermost;
+}
+
+void* big_integer_arena::allocate(size_t bytes)
+{
+    bytes = (bytes + alignment - 1) / alignment * alignment + sizeof(chunk*);
+    if (static_cast<size_t>(end - next) < bytes)
+    {
+        size_t size = chunks == nullptr ? first_chunk : std::min(2 * chunks->size, max_chunk);
+        size = std::max(size, bytes + sizeof(chunk));
+        chunk* c = take_spare(size);
+        if (c == nullptr)
+        {
+            c = static_cast<chunk*>(::operator new(size));
+            c->size = size;
+        }
+        new (&c->users) decltype(c->users)(1);
+        c->previous = chunks;
+        chunks = c;
+        next = reinterpret_cast<char*>(c) + sizeof(chunk);
+        end = reinterpret_cast<char*>(c) + c->size;
+    }
+    chunk* c = chunks;
+#ifdef BIG_INTEGER_SINGLE_THREADED
+    ++c->users;
+#else
+    c->users.fetch_add(1, std::memory_order_relaxed);
+#endif
+    *reinterpret_cast<chunk**>(next) = c;
+    void* r = next + sizeof(chunk*);
+    next += bytes;
+    total += bytes;
+    return r;
+}
+
+void big_integer_arena::deallocate(void* p) noexcept
+{
+    chunk* c = reinterpret_cast<chunk**>(p)[-1];
+#ifdef BIG_INTEGER_SINGLE_THREADED
+    bool last = --c->users == 0;
+#else
+    bool last = c->users.fetch_sub(1, std::memory_order_acq_rel) == 1;
+#endif
+    // only once the arena has ended, which then left the chunk out of the spare ones
+    if (last)
+        ::operator delete(c);
+}
+
+size_t big_integer_arena::depth() noexcept
+{
+    return innermost != nullptr ? innermost->level : 0;
+}
+
+size_t big_integer_arena::used() const noexcept
+{
+    return total;
+}
@@ -0,0 +1,65 @@
+#ifndef BIG_INTEGER_ARENA_H
+#define BIG_INTEGER_ARENA_H
+
+#include <cstddef>
+
+#include "big_integer.h"
+
+// A scope for short-lived temporaries. Every big_integer made while one is the innermost arena
+// of the thread takes the limb buffers it allocates from a list of chunks that double in size,
+// where freeing a buffer costs nothing; the destructor releases the chunks at once, keeping up
+// to 64 MiB of them on the thread for the next arena. Arenas nest, and must end on the thread
+// and in the reverse order they began.
+//
+// Values made outside the scope never point into it: they grow on the heap, and take a copy
+// of arena limbs they receive by assignment or swap, so an outer accumulator can be updated
+// inside. A copy or a move of a value that lives in the arena lands on the heap as well, so
+// a value pushed into an outer container or moved out of the scope owns ordinary memory.
+// A value that leaves with no copy or move at all, as a named return does under copy elision,
+// keeps its arena buffer: a chunk goes only once the arena has ended and none of its buffers
+// is in use, so such a value stays valid and holds its chunk until it is destroyed. keep()
+// copies a value to ordinary memory to let the chunk go sooner.
+struct big_integer_arena
+{
+    big_integer_arena();
+    ~big_integer_arena();
+
+    big_integer_arena(big_integer_arena const&) = delete;
+    big_integer_arena& operator=(big_integer_arena const&) = delete;
+
+    // x with its limbs outside every arena
+    static big_integer keep(big_integer const& x);
+
+    // the innermost arena of the calling thread, nullptr if none
+    static big_integer_arena* current() noexcept;
+    // how many arenas are active on the calling thread
+    static size_t depth() noexcept;
+
+    // 8-aligned memory that stays valid until it is passed to deallocate, after the arena
+    // ends if need be
+    void* allocate(size_t bytes);
+    // p from allocate of any arena of the thread, ended or not; another thread may deallocate
+    // unless BIG_INTEGER_SINGLE_THREADED is defined
+    static void deallocate(void* p) noexcept;
+    // bytes allocated so far
+    size_t used() const noexcept;
+
+private:
+    struct chunk;
+    // chunks of ended arenas, kept for the next ones on the thread
+    struct spare_chunks;
+
+    // a spare chunk of at least size bytes, nullptr if there is none
+    static chunk* take_spare(size_t size);
+
+    static thread_local spare_chunks spare;
+
+    big_integer_arena* outer;
+    size_t level;
+    chunk* chunks;
+    char* next;
+    char* end;
+    size_t total;
+};
+
+#endif // BIG_INTEGER_ARENA_H
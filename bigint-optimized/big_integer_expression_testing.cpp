@@ -0,0 +1,63 @@
+#define BIG_INTEGER_EXPRESSION_TEMPLATES
+
+#include <string>
+#include <type_traits>
+#include <gtest/gtest.h>
+
+#include "big_integer.h"
+
+TEST(expression_templates, product_is_lazy) {
+  big_integer a = 6, b = 7;
+  static_assert(std::is_same<decltype(a * b), big_integer_product>::value, "");
+  big_integer c = a * b;
+  EXPECT_EQ(42, c);
+  EXPECT_EQ(42, big_integer(a * b));
+  EXPECT_EQ("-42", to_string(-(a * b)));
+  EXPECT_TRUE(a * b == 42);
+  EXPECT_EQ(7, a * b / 6);
+  EXPECT_EQ(252, a * b * 6);
+  EXPECT_EQ(84, a * b + b * a);
+  EXPECT_EQ(0, a * b - b * a);
+}
+
+TEST(expression_templates, fused_accumulate) {
+  big_integer a("100000000000000000000000000000");
+  big_integer b("-3");
+  big_integer w = 7;
+
+  big_integer x = w;
+  x += a * b;
+  EXPECT_EQ(big_integer("-299999999999999999999999999993"), x);
+  x -= a * b;
+  EXPECT_EQ(7, x);
+  x -= b * b;
+  EXPECT_EQ(-2, x);
+  x += x * x;
+  EXPECT_EQ(2, x);
+
+  x = a * b + w;
+  EXPECT_EQ(big_integer("-299999999999999999999999999993"), x);
+  x = w + a * b;
+  EXPECT_EQ(big_integer("-299999999999999999999999999993"), x);
+  x = w - a * b;
+  EXPECT_EQ(big_integer("300000000000000000000000000007"), x);
+  x = a * b + x;
+  EXPECT_EQ(7, x);
+  x += a * 2;
+  EXPECT_EQ(big_integer("200000000000000000000000000007"), x);
+}
+
+TEST(expression_templates, long_operands) {
+  big_integer y = 1, z = -1;
+  for (int i = 0; i != 100; ++i) {
+    y = y * 1000003 + i;
+    z = z * 999983 - i;
+  }
+  big_integer acc = 0, expected = 0;
+  for (int i = 0; i != 20; ++i) {
+    acc += y * z;
+    acc -= z * z;
+    expected = expected + big_integer(y * z) - big_integer(z * z);
+  }
+  EXPECT_EQ(expected, acc);
+}
@@ -8,6 +8,7 @@
 struct big_integer_gmp {
   big_integer_gmp();
   big_integer_gmp(big_integer_gmp const& other);
+  big_integer_gmp(big_integer_gmp&& other) noexcept;
   big_integer_gmp(int a);
   explicit big_integer_gmp(std::string const& str);
 
@@ -27,6 +28,9 @@ struct big_integer_gmp {
   ~big_integer_gmp();
 
   big_integer_gmp& operator=(big_integer_gmp const& other);
+  big_integer_gmp& operator=(big_integer_gmp&& other) noexcept;
+
+  void swap(big_integer_gmp& other) noexcept;
 
   big_integer_gmp& operator+=(big_integer_gmp const& rhs);
   big_integer_gmp& operator-=(big_integer_gmp const& rhs);
@@ -42,7 +46,8 @@ struct big_integer_gmp {
   big_integer_gmp& operator>>=(int rhs);
 
   big_integer_gmp operator+() const;
-  big_integer_gmp operator-() const;
+  big_integer_gmp operator-() const&;
+  big_integer_gmp operator-() &&;
   big_integer_gmp operator~() const;
 
   big_integer_gmp& operator++();
@@ -59,20 +64,29 @@ struct big_integer_gmp {
   friend bool operator>=(big_integer_gmp const& a, big_integer_gmp const& b);
 
   friend std::string to_string(big_integer_gmp const& a);
+  friend big_integer_gmp powmod(big_integer_gmp const& base, big_integer_gmp const& exp, big_integer_gmp const& mod);
+  friend big_integer_gmp gcd(big_integer_gmp const& a, big_integer_gmp const& b);
+  friend big_integer_gmp iroot(big_integer_gmp const& a, unsigned long k);
 
  private:
   mpz_t mpz;
 };
 
 big_integer_gmp operator+(big_integer_gmp a, big_integer_gmp const& b);
+big_integer_gmp operator+(big_integer_gmp const& a, big_integer_gmp&& b);
 big_integer_gmp operator-(big_integer_gmp a, big_integer_gmp const& b);
+big_integer_gmp operator-(big_integer_gmp const& a, big_integer_gmp&& b);
 big_integer_gmp operator*(big_integer_gmp a, big_integer_gmp const& b);
+big_integer_gmp operator*(big_integer_gmp const& a, big_integer_gmp&& b);
 big_integer_gmp operator/(big_integer_gmp a, big_integer_gmp const& b);
 big_integer_gmp operator%(big_integer_gmp a, big_integer_gmp const& b);
 
 big_integer_gmp operator&(big_integer_gmp a, big_integer_gmp const& b);
+big_integer_gmp operator&(big_integer_gmp const& a, big_integer_gmp&& b);
 big_integer_gmp operator|(big_integer_gmp a, big_integer_gmp const& b);
+big_integer_gmp operator|(big_integer_gmp const& a, big_integer_gmp&& b);
 big_integer_gmp operator^(big_integer_gmp a, big_integer_gmp const& b);
+big_integer_gmp operator^(big_integer_gmp const& a, big_integer_gmp&& b);
 
 big_integer_gmp operator<<(big_integer_gmp a, int b);
 big_integer_gmp operator>>(big_integer_gmp a, int b);
@@ -84,6 +98,15 @@ bool operator>(big_integer_gmp const& a, big_integer_gmp const& b);
 bool operator<=(big_integer_gmp const& a, big_integer_gmp const& b);
 bool operator>=(big_integer_gmp const& a, big_integer_gmp const& b);
 
+// base^exp mod |mod| in [0, |mod|), exp >= 0
+big_integer_gmp powmod(big_integer_gmp const& base, big_integer_gmp const& exp, big_integer_gmp const& mod);
+// nonnegative
+big_integer_gmp gcd(big_integer_gmp const& a, big_integer_gmp const& b);
+// a^(1/k) truncated toward zero, k >= 1, a >= 0 for even k
+big_integer_gmp iroot(big_integer_gmp const& a, unsigned long k);
+
+void swap(big_integer_gmp& a, big_integer_gmp& b) noexcept;
+
 std::string to_string(big_integer_gmp const& a);
 std::ostream& operator<<(std::ostream& s, big_integer_gmp const& a);
 
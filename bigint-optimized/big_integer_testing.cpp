@@ -1,13 +1,25 @@
 #include <algorithm>
 #include <cassert>
 #include <cstdlib>
+#include <cstring>
 #include <random>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
 #include <vector>
 #include <utility>
 #include <gtest/gtest.h>
 
 #include "big_integer.h"
 #include "big_integer_gmp.h"
+#include "limbs.h"
+#ifdef BIG_INTEGER_POOL
+#include "limb_pool.h"
+#endif
+#if __has_include("big_integer_arena.h")
+#include "big_integer_arena.h"
+#define HAS_BIG_INTEGER_ARENA
+#endif
 
 TEST(correctness, two_plus_two) {
   EXPECT_EQ(big_integer(4), big_integer(2) + big_integer(2));
@@ -76,6 +88,61 @@ TEST(correctness, assignment_return_value) {
   EXPECT_TRUE(b == 7);
 }
 
+TEST(correctness, move_ctor_and_assignment) {
+  static_assert(std::is_nothrow_move_constructible<big_integer>::value, "");
+  static_assert(std::is_nothrow_move_assignable<big_integer>::value, "");
+
+  big_integer a("-123456789012345678901234567890");
+  big_integer b = std::move(a);
+  EXPECT_EQ(big_integer("-123456789012345678901234567890"), b);
+  EXPECT_EQ(0, a);
+
+  a = 5;
+  a = std::move(b);
+  EXPECT_EQ(big_integer("-123456789012345678901234567890"), a);
+  EXPECT_EQ(0, b);
+
+  a = std::move(a);
+  EXPECT_EQ(big_integer("-123456789012345678901234567890"), a);
+}
+
+TEST(correctness, swap) {
+  big_integer a("123456789012345678901234567890");
+  big_integer b = -7;
+  swap(a, b);
+  EXPECT_EQ(-7, a);
+  EXPECT_EQ(big_integer("123456789012345678901234567890"), b);
+  a.swap(b);
+  EXPECT_EQ(-7, b);
+}
+
+TEST(correctness, rvalue_operators) {
+  big_integer a("100000000000000000000000000000");
+  big_integer b("-3");
+  big_integer c("7");
+
+  EXPECT_EQ(big_integer("-299999999999999999999999999993"), a * b + c);
+  EXPECT_EQ(big_integer("300000000000000000000000000007"), c - a * b);
+  EXPECT_EQ(big_integer("-2100000000000000000000000000000"), a * (b * c) / 1);
+  EXPECT_EQ(big_integer("-100000000000000000000000000003"), -a + b);
+  EXPECT_EQ(big_integer("100000000000000000000000000003"), -(b - a));
+  EXPECT_EQ(c & 5, c & (b + 8));
+  EXPECT_EQ(c | 5, c | (b + 8));
+  EXPECT_EQ(c ^ 5, c ^ (b + 8));
+
+  big_integer t = a;
+  EXPECT_EQ(0, t - std::move(t));
+}
+
+TEST(correctness, sort_moves) {
+  std::vector<big_integer> v;
+  for (int i = 0; i != 100; ++i)
+    v.push_back(big_integer(std::to_string(i * 7919 % 100)) << 200);
+  std::sort(v.begin(), v.end());
+  for (int i = 0; i != 100; ++i)
+    EXPECT_EQ(big_integer(i) << 200, v[i]);
+}
+
 TEST(correctness, comparisons) {
   big_integer a = 100;
   big_integer b = 100;
@@ -100,6 +167,44 @@ TEST(correctness, compare_zero_and_minus_zero) {
   EXPECT_TRUE(a == b);
 }
 
+TEST(correctness, hash) {
+  std::hash<big_integer> h;
+  big_integer a("123456789012345678901234567890123456789012345678901234567890");
+  big_integer b = a;
+
+  EXPECT_EQ(h(a), h(b));
+  EXPECT_EQ(h(big_integer(0)), h(-big_integer(0)));
+  EXPECT_NE(h(a), h(-a));
+
+  // b is hashed before every mutation, which must not leave a stale hash behind
+  auto check = [&] { EXPECT_EQ(h(big_integer(to_string(b))), h(b)); };
+  check();
+  b += 1;
+  check();
+  b *= b;
+  check();
+  b >>= 3;
+  check();
+  b ^= a;
+  check();
+  b /= 7;
+  check();
+  b %= 1000000007;
+  check();
+  b = -std::move(b);
+  check();
+  big_integer c = a;
+  b.swap(c);
+  check();
+
+  std::unordered_map<big_integer, int> map;
+  for (int i = -100; i != 100; ++i)
+    map[a * i] = i;
+  EXPECT_EQ(200u, map.size());
+  for (int i = -100; i != 100; ++i)
+    EXPECT_EQ(i, map[a * i]);
+}
+
 TEST(correctness, add) {
   big_integer a = 5;
   big_integer b = 20;
@@ -249,6 +354,510 @@ TEST(correctness, div_return_value) {
   EXPECT_EQ(25, a);
 }
 
+TEST(correctness, divmod) {
+  big_integer a("-1000000000000000000000000000000000000000000000000000000000000000000000000000000000000000007");
+  big_integer b("123456789012345678901234567890123456789");
+
+  std::pair<big_integer, big_integer> qr = divmod(a, b);
+  EXPECT_EQ(a / b, qr.first);
+  EXPECT_EQ(a % b, qr.second);
+  EXPECT_EQ(a, qr.first * b + qr.second);
+
+  qr = divmod(b, a);
+  EXPECT_EQ(0, qr.first);
+  EXPECT_EQ(b, qr.second);
+}
+
+TEST(correctness, divmod_reciprocal) {
+  big_integer a("-1000000000000000000000000000000000000000000000000000000000000000000000000000000000000000007");
+  big_integer b("-123456789012345678901234567890123456789");
+  big_integer_reciprocal rb(b);
+
+  std::pair<big_integer, big_integer> qr = divmod(a, rb);
+  EXPECT_EQ(a / b, qr.first);
+  EXPECT_EQ(a % b, qr.second);
+
+  qr = divmod(-a, rb);
+  EXPECT_EQ(-a / b, qr.first);
+  EXPECT_EQ(-a % b, qr.second);
+
+  qr = divmod(b, rb);
+  EXPECT_EQ(1, qr.first);
+  EXPECT_EQ(0, qr.second);
+
+  qr = divmod(5, big_integer_reciprocal(-3));
+  EXPECT_EQ(-1, qr.first);
+  EXPECT_EQ(2, qr.second);
+
+  EXPECT_THROW(big_integer_reciprocal(0), std::runtime_error);
+}
+
+TEST(correctness, addmul_submul) {
+  big_integer a("100000000000000000000000000000");
+  big_integer b("-3");
+  big_integer x = 7;
+
+  x.addmul(a, b);
+  EXPECT_EQ(big_integer("-299999999999999999999999999993"), x);
+  x.submul(a, b);
+  EXPECT_EQ(7, x);
+  x.submul(b, b).submul(a, 0);
+  EXPECT_EQ(-2, x);
+  x.addmul(x, x);
+  EXPECT_EQ(2, x);
+  x.submul(x, a);
+  EXPECT_EQ(big_integer("-199999999999999999999999999998"), x);
+
+  big_integer y = 0;
+  y.submul(a, a);
+  EXPECT_EQ(-(a * a), y);
+  y.addmul(a, a);
+  EXPECT_EQ(0, y);
+}
+
+TEST(correctness, powmod) {
+  // the first argument is spelled out, big_integer_gmp has a powmod of its own
+  EXPECT_EQ(445, powmod(big_integer(4), 13, 497));
+  EXPECT_EQ(445, powmod(big_integer(4), 13, -497));
+  EXPECT_EQ(497 - 445, powmod(big_integer(-4), 13, 497));
+  EXPECT_EQ(376, powmod(big_integer(2), 100, 1000));
+  EXPECT_EQ(1, powmod(big_integer(12345), 0, 7));
+  EXPECT_EQ(0, powmod(big_integer(12345), 0, 1));
+  EXPECT_EQ(0, powmod(big_integer(0), 5, 8));
+
+  // Fermat: a^(p-1) = 1 mod p for the Mersenne prime 2^127 - 1
+  big_integer p = (big_integer(1) << 127) - 1;
+  EXPECT_EQ(1, powmod(big_integer("123456789123456789123456789"), p - 1, p));
+  EXPECT_EQ(big_integer(1) << 200, powmod(big_integer(2), 300, big_integer(3) << 200));
+
+  EXPECT_THROW(powmod(big_integer(2), -1, 7), std::runtime_error);
+  EXPECT_THROW(powmod(big_integer(2), 3, 0), std::runtime_error);
+}
+
+TEST(correctness, montgomery_context) {
+  big_integer m("340282366920938463463374607431768211507"); // 2^128 + 51
+  montgomery_context ctx(m);
+  big_integer a("123456789012345678901234567890"), b("-98765432109876543210");
+
+  big_integer ma = ctx.to_montgomery(a), mb = ctx.to_montgomery(b);
+  EXPECT_EQ(a % m, ctx.from_montgomery(ma));
+  EXPECT_EQ((a * b % m + m) % m, ctx.from_montgomery(ctx.multiply(ma, mb)));
+  EXPECT_EQ(a * a % m, ctx.from_montgomery(ctx.multiply(ma, ma)));
+  EXPECT_EQ(powmod(a, b * b, m), ctx.pow(a, b * b));
+  EXPECT_EQ(m, ctx.modulus());
+
+  // results written over a copy of an operand whose hash was taken hash as their value does
+  big_integer ha = ma;
+  (void)ha.hash();
+  big_integer p = ctx.multiply(ha, mb), q = ctx.to_montgomery(ha);
+  EXPECT_EQ(big_integer(to_string(p)).hash(), p.hash());
+  EXPECT_EQ(big_integer(to_string(q)).hash(), q.hash());
+
+  EXPECT_THROW(montgomery_context(big_integer(1) << 100), std::runtime_error);
+  EXPECT_THROW(montgomery_context(1), std::runtime_error);
+}
+
+TEST(correctness, gcd) {
+  // the arguments are spelled out, big_integer_gmp has a gcd of its own
+  EXPECT_EQ(6, gcd(big_integer(12), big_integer(18)));
+  EXPECT_EQ(6, gcd(big_integer(-12), big_integer(18)));
+  EXPECT_EQ(6, gcd(big_integer(12), big_integer(-18)));
+  EXPECT_EQ(7, gcd(big_integer(0), big_integer(-7)));
+  EXPECT_EQ(7, gcd(big_integer(-7), big_integer(0)));
+  EXPECT_EQ(0, gcd(big_integer(0), big_integer(0)));
+  EXPECT_EQ(1, gcd(big_integer("1000000000000000000000000000000000000007"), big_integer(1) << 200));
+  EXPECT_EQ(big_integer(3) << 150, gcd(big_integer(9) << 150, big_integer(15) << 170));
+
+  EXPECT_EQ(36, lcm(big_integer(12), big_integer(-18)));
+  EXPECT_EQ(0, lcm(big_integer(0), big_integer(5)));
+  EXPECT_EQ(big_integer(45) << 170, lcm(big_integer(9) << 150, big_integer(15) << 170));
+}
+
+TEST(correctness, gcdext) {
+  auto [g, s, t] = gcdext(240, 46);
+  EXPECT_EQ(2, g);
+  EXPECT_EQ(-9, s);
+  EXPECT_EQ(47, t);
+
+  std::tie(g, s, t) = gcdext(-240, 46);
+  EXPECT_EQ(2, g);
+  EXPECT_EQ(9, s);
+  EXPECT_EQ(47, t);
+
+  std::tie(g, s, t) = gcdext(5, 0);
+  EXPECT_EQ(5, g);
+  EXPECT_EQ(1, s);
+  EXPECT_EQ(0, t);
+
+  std::tie(g, s, t) = gcdext(0, -5);
+  EXPECT_EQ(5, g);
+  EXPECT_EQ(0, s);
+  EXPECT_EQ(-1, t);
+
+  std::tie(g, s, t) = gcdext(0, 0);
+  EXPECT_EQ(0, g);
+  EXPECT_EQ(0, s);
+  EXPECT_EQ(0, t);
+}
+
+TEST(correctness, modinv) {
+  EXPECT_EQ(4, modinv(3, 11));
+  EXPECT_EQ(4, modinv(3, -11));
+  EXPECT_EQ(7, modinv(-3, 11));
+  EXPECT_EQ(0, modinv(5, 1));
+
+  big_integer p = (big_integer(1) << 127) - 1;
+  big_integer a("123456789123456789123456789");
+  EXPECT_EQ(1, a * modinv(a, p) % p);
+  EXPECT_EQ(powmod(a, p - 2, p), modinv(a, p));
+
+  EXPECT_THROW(modinv(6, 9), std::runtime_error);
+  EXPECT_THROW(modinv(6, 0), std::runtime_error);
+}
+
+TEST(correctness, isqrt) {
+  EXPECT_EQ(0, isqrt(0));
+  EXPECT_EQ(1, isqrt(3));
+  EXPECT_EQ(2, isqrt(4));
+  EXPECT_EQ(3, isqrt(15));
+  EXPECT_EQ(big_integer(1) << 100, isqrt(big_integer(1) << 200));
+  EXPECT_EQ((big_integer(1) << 100) - 1, isqrt((big_integer(1) << 200) - 1));
+  big_integer a("123456789012345678901234567890123456789");
+  EXPECT_EQ(a, isqrt(a * a));
+  EXPECT_EQ(a, isqrt(a * a + 2 * a));
+  EXPECT_EQ(a - 1, isqrt(a * a - 1));
+
+  EXPECT_THROW(isqrt(-1), std::runtime_error);
+}
+
+TEST(correctness, iroot) {
+  // the arguments are spelled out, big_integer_gmp has an iroot of its own
+  EXPECT_EQ(3, iroot(big_integer(27), 3));
+  EXPECT_EQ(2, iroot(big_integer(26), 3));
+  EXPECT_EQ(-3, iroot(big_integer(-27), 3));
+  EXPECT_EQ(-2, iroot(big_integer(-26), 3));
+  EXPECT_EQ(12345, iroot(big_integer(12345), 1));
+  EXPECT_EQ(1, iroot(big_integer(1) << 100, 101));
+  EXPECT_EQ(2, iroot(big_integer(1) << 100, 100));
+  EXPECT_EQ(0, iroot(big_integer(0), 7));
+
+  big_integer a("98765432109876543210987654321");
+  big_integer a5 = a * a * a * a * a;
+  EXPECT_EQ(a, iroot(a5, 5));
+  EXPECT_EQ(a - 1, iroot(a5 - 1, 5));
+  EXPECT_EQ(-a, iroot(-a5, 5));
+  EXPECT_EQ(isqrt(a5), iroot(a5, 2));
+
+  EXPECT_THROW(iroot(big_integer(-4), 2), std::runtime_error);
+  EXPECT_THROW(iroot(big_integer(5), 0), std::runtime_error);
+}
+
+TEST(correctness, is_perfect_square) {
+  EXPECT_TRUE(is_perfect_square(0));
+  EXPECT_TRUE(is_perfect_square(1));
+  EXPECT_TRUE(is_perfect_square(144));
+  EXPECT_FALSE(is_perfect_square(2));
+  EXPECT_FALSE(is_perfect_square(-4));
+
+  big_integer a("123456789012345678901234567890123456789");
+  EXPECT_TRUE(is_perfect_square(a * a));
+  EXPECT_FALSE(is_perfect_square(a * a + 1));
+  EXPECT_FALSE(is_perfect_square(a * a - 1));
+  // passes the residue tests: a square modulo 64, 63, 65 and 11
+  EXPECT_FALSE(is_perfect_square(a * a * 64 * 63 * 65 * 11 * 64 * 63 * 65 * 11 + 64 * 63 * 65 * 11));
+}
+
+TEST(correctness, two_limb_boundary) {
+  // values around 2^128, where storage with room for two limbs moves to the heap and back
+  big_integer const max2 = (big_integer(1) << 128) - 1;
+  big_integer a = max2;
+  a += 1;
+  EXPECT_EQ(big_integer(1) << 128, a);
+  a -= 1;
+  EXPECT_EQ(max2, a);
+  a *= a;
+  EXPECT_EQ((big_integer(1) << 256) - (big_integer(1) << 129) + 1, a);
+  a %= max2 + 2;
+  EXPECT_EQ(4, a);
+
+  big_integer b = max2;
+  b += b;
+  EXPECT_EQ(max2 * 2, b);
+  b = b;
+  EXPECT_EQ(max2 * 2, b);
+  b >>= 1;
+  EXPECT_EQ(max2, b);
+
+  big_integer small = 7, large = max2 << 64;
+  swap(small, large);
+  EXPECT_EQ(7, large);
+  EXPECT_EQ(max2 << 64, small);
+  big_integer moved = std::move(small);
+  EXPECT_EQ(max2 << 64, moved);
+  EXPECT_EQ(0, small);
+  small = std::move(large);
+  EXPECT_EQ(7, small);
+  small = moved;
+  EXPECT_EQ(max2 << 64, small);
+}
+
+TEST(correctness, copies_are_independent) {
+  big_integer const a = (big_integer(1) << 1000) + 12345;
+  big_integer b = a, c = a, d = a, e;
+  e = a;
+  b += 1;
+  c <<= 3;
+  d.swap(c);
+  e = -e;
+  big_integer f = e;
+  ++f;
+  EXPECT_EQ((big_integer(1) << 1000) + 12345, a);
+  EXPECT_EQ(a + 1, b);
+  EXPECT_EQ(a, c);
+  EXPECT_EQ(a * 8, d);
+  EXPECT_EQ(-a, e);
+  EXPECT_EQ(1 - a, f);
+
+  std::vector<big_integer> v(4, a);
+  v[1] *= v[1];
+  v[2] = v[1];
+  v[2] /= a;
+  EXPECT_EQ(a, v[0]);
+  EXPECT_EQ(a * a, v[1]);
+  EXPECT_EQ(a, v[2]);
+  EXPECT_EQ(a, v[3]);
+}
+
+#ifndef BIG_INTEGER_SINGLE_THREADED
+TEST(correctness, copies_across_threads) {
+  big_integer const a = (big_integer(3) << 5000) - 1;
+  std::vector<big_integer> results(4);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i != results.size(); ++i) {
+    threads.emplace_back([&a, &results, i] {
+      for (int itn = 0; itn != 100; ++itn) {
+        big_integer x = a;
+        x += static_cast<int>(i);
+        results[i] = x;
+      }
+    });
+  }
+  for (std::thread& t : threads)
+    t.join();
+  for (size_t i = 0; i != results.size(); ++i)
+    EXPECT_EQ(a + static_cast<int>(i), results[i]);
+}
+#endif
+
+#ifdef BIG_INTEGER_POOL
+TEST(correctness, limb_pool) {
+  EXPECT_EQ(64u, limb_pool::block_size(1));
+  EXPECT_EQ(64u, limb_pool::block_size(64));
+  EXPECT_EQ(128u, limb_pool::block_size(65));
+  EXPECT_EQ(limb_pool::max_block, limb_pool::block_size(limb_pool::max_block));
+  EXPECT_EQ(limb_pool::max_block + 1, limb_pool::block_size(limb_pool::max_block + 1));
+
+  big_integer const a = (big_integer(1) << 1000) + 1;
+  limb_pool::release_cached();
+  limb_pool::statistics before = limb_pool::thread_statistics();
+  EXPECT_EQ(0u, before.cached_bytes);
+  for (int itn = 0; itn != 100; ++itn) {
+    big_integer b = a;
+    b += 1;
+  }
+  limb_pool::statistics after = limb_pool::thread_statistics();
+  // every block comes back, and the later copies are served from the cache
+  EXPECT_GT(after.allocations - before.allocations, 0u);
+  EXPECT_EQ(after.allocations - before.allocations, after.deallocations - before.deallocations);
+  EXPECT_GT(after.reuses - before.reuses, 0u);
+  EXPECT_GT(after.cached_bytes, 0u);
+  limb_pool::release_cached();
+  EXPECT_EQ(0u, limb_pool::thread_statistics().cached_bytes);
+}
+#endif
+
+#ifdef HAS_BIG_INTEGER_ARENA
+TEST(correctness, arena) {
+  big_integer const outside = (big_integer(1) << 500) + 3;
+  big_integer kept, shared_copy = outside;
+  {
+    big_integer_arena arena;
+    EXPECT_EQ(&arena, big_integer_arena::current());
+    big_integer x = outside;
+    big_integer f = 1;
+    for (int i = 1; i != 100; ++i) {
+      f *= i;
+      x += f;
+    }
+    EXPECT_GT(arena.used(), 0u);
+    // arena buffers are copied, not shared
+    big_integer y = x;
+    y -= 1;
+    EXPECT_EQ(x - 1, y);
+    {
+      big_integer_arena inner;
+      EXPECT_EQ(&inner, big_integer_arena::current());
+      big_integer z = x * x;
+      EXPECT_EQ(x, z / x);
+    }
+    EXPECT_EQ(&arena, big_integer_arena::current());
+    kept = big_integer_arena::keep(x);
+    // a copy of outside limbs shares them until written
+    big_integer w = shared_copy;
+    w += 1;
+    EXPECT_EQ(outside + 1, w);
+  }
+  EXPECT_EQ(nullptr, big_integer_arena::current());
+  big_integer f = 1, expected = outside;
+  for (int i = 1; i != 100; ++i) {
+    f *= i;
+    expected += f;
+  }
+  EXPECT_EQ(expected, kept);
+  EXPECT_EQ(outside, shared_copy);
+}
+
+namespace {
+// returned by copy elision, so r is the caller's value and was made in the arena
+big_integer power_in_arena(big_integer const& x, int k) {
+  big_integer_arena arena;
+  big_integer r = 1;
+  for (int i = 0; i != k; ++i)
+    r *= x;
+  return r;
+}
+
+// fills the spare chunks a dangling value could point into
+void overwrite_arena_chunks() {
+  big_integer_arena arena;
+  std::vector<void*> blocks;
+  while (arena.used() < (size_t(8) << 20)) {
+    blocks.push_back(arena.allocate(4096));
+    std::memset(blocks.back(), 0x77, 4096);
+  }
+  for (void* p : blocks)
+    big_integer_arena::deallocate(p);
+}
+} // namespace
+
+TEST(correctness, arena_values_made_outside) {
+  big_integer sum = big_integer(1) << 300;
+  big_integer product = (big_integer(1) << 200) + 1;
+  big_integer assigned = 5, moved_to = 7, swapped = 9;
+  std::vector<big_integer> values;
+  // no reallocation moves the elements to the heap
+  values.reserve(3);
+  {
+    big_integer_arena arena;
+    sum += big_integer(3) << 400;
+    for (int i = 0; i != 50; ++i)
+      sum += big_integer(i) << (10 * i);
+    product *= product;
+    // grown in place, so in the arena
+    big_integer t = 1;
+    t <<= 500;
+    t -= 1;
+    assigned = t;
+    moved_to = t + 1;
+    big_integer u = t - 1;
+    swap(swapped, u);
+    EXPECT_EQ(power_in_arena(t + 2, 10), power_in_arena(t + 2, 5) * power_in_arena(t + 2, 5));
+    // copies and moves of arena values take no arena memory
+    size_t used = arena.used();
+    values.push_back(t);
+    big_integer copy = t;
+    EXPECT_EQ(used, arena.used());
+    values.push_back(std::move(t));
+    EXPECT_EQ(used, arena.used());
+    EXPECT_EQ(copy, values[0]);
+    // made in place in the arena
+    values.emplace_back("1000000000000000000000000000000000000000000000000000000000000");
+  }
+  big_integer returned = power_in_arena(big_integer(3) << 100, 7);
+  overwrite_arena_chunks();
+
+  big_integer expected = (big_integer(1) << 300) + (big_integer(3) << 400);
+  for (int i = 0; i != 50; ++i)
+    expected += big_integer(i) << (10 * i);
+  EXPECT_EQ(expected, sum);
+  EXPECT_EQ((big_integer(1) << 400) + (big_integer(1) << 201) + 1, product);
+  EXPECT_EQ((big_integer(1) << 500) - 1, assigned);
+  EXPECT_EQ(big_integer(1) << 500, moved_to);
+  EXPECT_EQ((big_integer(1) << 500) - 2, swapped);
+  ASSERT_EQ(3u, values.size());
+  EXPECT_EQ((big_integer(1) << 500) - 1, values[0]);
+  EXPECT_EQ((big_integer(1) << 500) - 1, values[1]);
+  EXPECT_EQ(big_integer("1" + std::string(60, '0')), values[2]);
+  EXPECT_EQ(big_integer(2187) << 700, returned);
+}
+#endif
+
+TEST(correctness, mixed_width_ctor) {
+  EXPECT_EQ(big_integer("-9223372036854775808"), big_integer(std::numeric_limits<long long>::min()));
+  EXPECT_EQ(big_integer("18446744073709551615"), big_integer(std::numeric_limits<unsigned long long>::max()));
+  EXPECT_EQ(big_integer("4294967295"), big_integer(4294967295u));
+  EXPECT_EQ(big_integer("-170141183460469231731687303715884105728"),
+            big_integer(static_cast<big_integer::int128_t>(static_cast<big_integer::uint128_t>(1) << 127)));
+  EXPECT_EQ(big_integer("340282366920938463463374607431768211455"), big_integer(~big_integer::uint128_t(0)));
+  EXPECT_EQ(0, big_integer(0ull));
+  EXPECT_EQ(1, big_integer(true));
+}
+
+TEST(correctness, mixed_width_arithmetic) {
+  big_integer a("-123456789012345678901234567890");
+  long long ll = -9876543210LL;
+  unsigned long long ull = 18446744073709551557ull;
+  big_integer::int128_t huge = static_cast<big_integer::int128_t>(ull) * 1000003;
+
+  EXPECT_EQ(a + big_integer(ll), a + ll);
+  EXPECT_EQ(a - big_integer(ll), a - ll);
+  EXPECT_EQ(big_integer(ll) - a, ll - a);
+  EXPECT_EQ(a * big_integer(ull), a * ull);
+  EXPECT_EQ(a * big_integer(huge), huge * a);
+  EXPECT_EQ(a / big_integer(ll), a / ll);
+  EXPECT_EQ(a % big_integer(ll), a % ll);
+  EXPECT_EQ(a / big_integer(huge), a / huge);
+  EXPECT_EQ(a % big_integer(huge), a % huge);
+  EXPECT_EQ(a & big_integer(ll), a & ll);
+  EXPECT_EQ(a | big_integer(ull), ull | a);
+  EXPECT_EQ(a ^ big_integer(-huge), a ^ -huge);
+  EXPECT_EQ(0, ll / a);
+  EXPECT_EQ(ll, ll % a);
+  EXPECT_EQ(big_integer(huge) / big_integer(ll), huge / big_integer(ll));
+  EXPECT_EQ(big_integer(huge) % big_integer(ll), huge % big_integer(ll));
+  EXPECT_EQ(big_integer(ull) / 7, ull / big_integer(7));
+  EXPECT_EQ(-3, -7 / big_integer(2));
+  EXPECT_EQ(-1, -7 % big_integer(2));
+  EXPECT_EQ(1, std::numeric_limits<long long>::min() % big_integer(3) + 3);
+  EXPECT_THROW(1 / big_integer(0), std::runtime_error);
+  EXPECT_THROW(1u % big_integer(0), std::runtime_error);
+
+  big_integer b = a;
+  b *= 0u;
+  EXPECT_EQ(0, b);
+  b -= std::numeric_limits<long long>::min();
+  EXPECT_EQ(big_integer("9223372036854775808"), b);
+  b /= -2;
+  EXPECT_EQ(big_integer("-4611686018427387904"), b);
+  b %= 1000000007ull;
+  EXPECT_EQ(big_integer("-4611686018427387904") % 1000000007, b);
+  EXPECT_THROW(b /= 0ll, std::runtime_error);
+  EXPECT_THROW(b %= big_integer::int128_t(0), std::runtime_error);
+}
+
+TEST(correctness, mixed_width_comparisons) {
+  big_integer a("18446744073709551616");
+  EXPECT_TRUE(a > std::numeric_limits<unsigned long long>::max());
+  EXPECT_TRUE(std::numeric_limits<unsigned long long>::max() < a);
+  EXPECT_TRUE(a - 1 == std::numeric_limits<unsigned long long>::max());
+  EXPECT_TRUE(a != std::numeric_limits<unsigned long long>::max());
+  EXPECT_TRUE(-a < std::numeric_limits<long long>::min());
+  EXPECT_TRUE(std::numeric_limits<long long>::min() >= -a);
+  EXPECT_TRUE(a <= big_integer::int128_t(1) << 64);
+  EXPECT_TRUE(0u == big_integer());
+  EXPECT_TRUE(-1 < big_integer() && big_integer() < 1ull);
+}
+
 TEST(correctness, unary_plus) {
   big_integer a = 123;
   big_integer b = +a;
@@ -429,6 +1038,31 @@ TEST(correctness, shr_return_value) {
   EXPECT_EQ(8, a);
 }
 
+TEST(correctness, shift_wide_counts) {
+  big_integer a("-340282366920938463463374607431768211457"); // -(1 << 128) - 1
+
+  EXPECT_EQ(-3, a >> size_t(127));
+  EXPECT_EQ(-2, a >> int64_t(128));
+  EXPECT_EQ(-1, a >> (int64_t(1) << 40));
+  EXPECT_EQ(0, -a >> (uint64_t(1) << 40));
+  EXPECT_EQ(a >> 64, a << int64_t(-64));
+  EXPECT_EQ(a * 4, a >> -2);
+
+  big_integer b = a;
+  b <<= uint64_t(1000);
+  b >>= uint64_t(1000);
+  EXPECT_EQ(a, b);
+
+  // unsigned counts past INT64_MAX must not wrap to a negative count and shift the other way
+  EXPECT_EQ(-1, a >> (uint64_t(1) << 63));
+  EXPECT_EQ(-1, a >> SIZE_MAX);
+  EXPECT_EQ(0, -a >> ~big_integer::uint128_t(0));
+  EXPECT_EQ(-1, a << -(big_integer::int128_t(1) << 100));
+  EXPECT_EQ(0, big_integer(0) << SIZE_MAX);
+  b >>= uint64_t(1) << 63;
+  EXPECT_EQ(-1, b);
+}
+
 TEST(correctness, add_long) {
   big_integer a("10000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000");
   big_integer b("100000000000000000000000000000000000000");
@@ -577,6 +1211,33 @@ TEST(correctness, string_conv) {
   EXPECT_EQ("-2147483649", to_string(lim));
 }
 
+TEST(correctness, string_conv_view) {
+  std::string s = "xx-123456789012345678901234567890yy";
+  big_integer expected("-123456789012345678901234567890");
+  EXPECT_EQ(expected, big_integer(std::string_view(s).substr(2, 31)));
+  EXPECT_EQ(expected, big_integer(s.data() + 2, 31));
+  EXPECT_EQ(-expected, big_integer(s.data() + 3, 30));
+  EXPECT_EQ(0, big_integer(s.data() + 3, 1) - 1);
+
+  EXPECT_THROW(big_integer(s.data(), 5), std::runtime_error);
+  EXPECT_THROW(big_integer(s.data() + 2, 32), std::runtime_error);
+  EXPECT_THROW(big_integer(s.data() + 2, 1), std::runtime_error);
+  EXPECT_THROW(big_integer(s.data(), 0), std::runtime_error);
+  EXPECT_THROW(big_integer(std::string_view()), std::runtime_error);
+}
+
+TEST(correctness, string_conv_powers_of_ten) {
+  big_integer p = 1;
+  for (size_t k = 1; k != 3000; ++k) {
+    p *= 10;
+    if (k % 19 == 0 || k % 19 == 18 || k % 97 == 0) {
+      EXPECT_EQ("1" + std::string(k, '0'), to_string(p));
+      EXPECT_EQ(std::string(k, '9'), to_string(p - 1));
+      EXPECT_EQ("-1" + std::string(k - 1, '0') + "1", to_string(-p - 1));
+    }
+  }
+}
+
 namespace {
 size_t const number_of_iterations = 10;
 size_t const max_size = 2048;
@@ -665,6 +1326,77 @@ TEST(correctness, mul_merge_randomized) {
   }
 }
 
+TEST(correctness, product_sum) {
+  std::vector<int> none;
+  EXPECT_EQ(1, product(none.begin(), none.end()));
+  EXPECT_EQ(0, sum(none.begin(), none.end()));
+
+  std::vector<int> small = {3, -5, 7, 11, -13};
+  EXPECT_EQ(15015, product(small.begin(), small.end()));
+  EXPECT_EQ(3, sum(small.begin(), small.end()));
+  small.push_back(0);
+  EXPECT_EQ(0, product(small.begin(), small.end()));
+
+  big_integer_accumulator acc;
+  EXPECT_EQ(0, acc.value());
+  acc += big_integer(1) << 200;
+  acc -= 1;
+  acc += -5;
+  EXPECT_EQ((big_integer(1) << 200) - 6, acc.value());
+  acc -= big_integer(1) << 201;
+  EXPECT_EQ(-(big_integer(1) << 200) - 6, acc.value());
+
+  for (unsigned itn = 0; itn != number_of_iterations; ++itn) {
+    std::vector<big_integer> x;
+    for (size_t i = 0; i != number_of_multipliers + itn; ++i)
+      x.emplace_back(myrand());
+
+    big_integer p = 1, s = 0;
+    for (big_integer const& v : x) {
+      p *= v;
+      s += v;
+    }
+    EXPECT_EQ(p, product(x.begin(), x.end()));
+    EXPECT_EQ(p, merge_all(x));
+    EXPECT_EQ(s, sum(x.begin(), x.end()));
+  }
+}
+
+TEST(correctness, literals) {
+  constexpr big_integer_view k = 147573952589676412928_bi;
+  static_assert(k.size == 2 && k.data[0] == 0 && k.data[1] == 8 && !k.negative, "2^67 parsed at compile time");
+  static_assert((-k).negative && !(-0_bi).negative && (0_bi).size == 0, "");
+  static_assert((0xffff'ffff'ffff'ffff'ffff_bi).size == 2 && (0b101_bi).data[0] == 5 && (017_bi).data[0] == 15, "");
+
+  big_integer a = k;
+  EXPECT_EQ(big_integer("147573952589676412928"), a);
+  EXPECT_EQ(big_integer("-147573952589676412928"), -k);
+  EXPECT_EQ((big_integer(1) << 80) - 1, 0xFFFF'FFFF'FFFF'FFFF'FFFF_bi);
+  EXPECT_EQ(big_integer("1000000000000000000000000000000000000000"), 1'000'000'000'000'000'000'000'000'000'000'000'000'000_bi);
+  EXPECT_EQ(0, 0_bi);
+  EXPECT_EQ("-147573952589676412928", to_string(-k));
+
+  big_integer b = 12345678901234567890123456789_bi;
+  EXPECT_EQ(big_integer("12345678901234567890123456789"), b);
+  EXPECT_EQ(big_integer("12345678901234567890123456789") + a, b + k);
+  EXPECT_EQ(big_integer("12345678901234567890123456789") - a, b - k);
+  EXPECT_EQ(big_integer("12345678901234567890123456789") * a, b * k);
+  EXPECT_EQ(big_integer("12345678901234567890123456789") / a, b / k);
+  EXPECT_EQ(big_integer("12345678901234567890123456789") % -a, b % -k);
+  EXPECT_EQ(big_integer("12345678901234567890123456789") & -a, b & -k);
+  EXPECT_EQ(a - b, k - b);
+  EXPECT_EQ(a * 2, k + k);
+  EXPECT_TRUE(b > k && k < b && k == a && -k != a && b >= k && -k <= a);
+  EXPECT_TRUE(k == a && -k < a);
+
+  b += 1_bi;
+  b -= 12345678901234567890123456790_bi;
+  EXPECT_EQ(0, b);
+  b = -k;
+  b *= -k;
+  EXPECT_EQ(big_integer(1) << 134, b);
+}
+
 namespace {
 big_integer rand_big(size_t size) {
   big_integer result = rand();
@@ -744,6 +1476,129 @@ TEST(correctness_random, mul) {
   }
 }
 
+TEST(correctness_random, sqr) {
+  std::default_random_engine rng(1729);
+  for (size_t bits = 64; bits <= 64 * 640; bits += bits / 3) {
+    big_integer_gmp a;
+    a.random(bits, rng);
+    if (bits % 2 != 0)
+      a = -a;
+    big_integer_gmp c = a * a;
+    big_integer A(to_string(a));
+    EXPECT_EQ(to_string(c), to_string(A * A));
+    A *= A;
+    EXPECT_EQ(to_string(c), to_string(A));
+  }
+}
+
+namespace {
+// products and squares of operands of about an and bn limbs against GMP, random and all ones
+void check_mul_sizes(size_t an, size_t bn, std::default_random_engine& rng) {
+  for (int ones = 0; ones != 2; ++ones) {
+    big_integer_gmp a, b;
+    a.random(64 * an - 1, rng);
+    b.random(64 * bn - 1, rng);
+    if (ones) {
+      a = (big_integer_gmp(1) << static_cast<int>(64 * an)) - big_integer_gmp(1);
+      b = (big_integer_gmp(1) << static_cast<int>(64 * bn)) - big_integer_gmp(1);
+    }
+    big_integer A(to_string(a)), B(to_string(b));
+    EXPECT_EQ(to_string(a * b), to_string(A * B));
+    EXPECT_EQ(to_string(a * b), to_string(B * A));
+    EXPECT_EQ(to_string(a * a), to_string(A * A));
+    EXPECT_EQ(to_string(a * a), to_string(A * big_integer(to_string(a))));
+  }
+}
+
+void check_mul_thresholds(std::default_random_engine& rng) {
+  size_t const sizes[] = {limbs::karatsuba_threshold, limbs::toom3_threshold,
+                          limbs::sqr_karatsuba_threshold, limbs::sqr_toom3_threshold};
+  for (size_t n : sizes) {
+    for (size_t m = n - 1; m <= n + 1; ++m) {
+      check_mul_sizes(m, m, rng);
+      check_mul_sizes(m, m - 1, rng);
+      // unbalanced operands are multiplied by slices of the longer one
+      check_mul_sizes(3 * m + n / 2, m, rng);
+      check_mul_sizes(5 * m, m, rng);
+    }
+  }
+  check_mul_sizes(2 * limbs::toom3_threshold + 5, 2 * limbs::toom3_threshold + 5, rng);
+  check_mul_sizes(7 * limbs::toom3_threshold, limbs::toom3_threshold + 3, rng);
+}
+
+// lowers the Karatsuba and Toom-3 thresholds of mul and sqr for its lifetime
+struct mul_thresholds {
+  mul_thresholds(size_t karatsuba, size_t toom3)
+      : karatsuba(limbs::karatsuba_threshold), toom3(limbs::toom3_threshold),
+        sqr_karatsuba(limbs::sqr_karatsuba_threshold), sqr_toom3(limbs::sqr_toom3_threshold) {
+    limbs::karatsuba_threshold = limbs::sqr_karatsuba_threshold = karatsuba;
+    limbs::toom3_threshold = limbs::sqr_toom3_threshold = toom3;
+  }
+  ~mul_thresholds() {
+    limbs::karatsuba_threshold = karatsuba;
+    limbs::toom3_threshold = toom3;
+    limbs::sqr_karatsuba_threshold = sqr_karatsuba;
+    limbs::sqr_toom3_threshold = sqr_toom3;
+  }
+
+  size_t karatsuba;
+  size_t toom3;
+  size_t sqr_karatsuba;
+  size_t sqr_toom3;
+};
+}
+
+TEST(correctness_random, mul_karatsuba_toom3) {
+  std::default_random_engine rng(1024);
+  check_mul_thresholds(rng);
+}
+
+TEST(correctness_random, mul_karatsuba_toom3_small) {
+  // small thresholds take operands of a few dozen limbs through several levels of recursion
+  std::default_random_engine rng(2048);
+  mul_thresholds small(4, 9);
+  check_mul_thresholds(rng);
+  for (size_t n = 1; n <= 80; ++n)
+    check_mul_sizes(n + rng() % 40, n, rng);
+}
+
+namespace {
+// lowers limbs::ntt_threshold for its lifetime
+struct ntt_threshold {
+  explicit ntt_threshold(size_t ntt) : ntt(limbs::ntt_threshold) {
+    limbs::ntt_threshold = ntt;
+  }
+  ~ntt_threshold() {
+    limbs::ntt_threshold = ntt;
+  }
+
+  size_t ntt;
+};
+}
+
+TEST(correctness_random, mul_ntt) {
+  // every product goes through the transform, all-one operands give the largest coefficients
+  std::default_random_engine rng(5040);
+  ntt_threshold small(1);
+  for (size_t bits = 64; bits <= 64 * 1200; bits += bits / 3) {
+    for (int ones = 0; ones != 2; ++ones) {
+      big_integer_gmp a, b;
+      a.random(bits, rng);
+      b.random(bits / 3 + 1, rng);
+      if (ones) {
+        a = (big_integer_gmp(1) << static_cast<int>(bits)) - big_integer_gmp(1);
+        b = (big_integer_gmp(1) << static_cast<int>(bits / 3 + 1)) - big_integer_gmp(1);
+      }
+      big_integer A(to_string(a)), B(to_string(b));
+      EXPECT_EQ(to_string(a * b), to_string(A * B));
+      EXPECT_EQ(to_string(a * a), to_string(A * A));
+      // equal operands stored apart take the general product
+      big_integer C(to_string(a));
+      EXPECT_EQ(to_string(a * a), to_string(A * C));
+    }
+  }
+}
+
 TEST(correctness_random, div) {
   std::default_random_engine rng(322);
   for (size_t itn = 0; itn != number_of_iterations; ++itn) {
@@ -776,6 +1631,237 @@ TEST(correctness_random, mod) {
   }
 }
 
+namespace {
+// lowers limbs::newton_threshold and limbs::newton_basecase_threshold for its lifetime
+struct newton_thresholds {
+  newton_thresholds(size_t newton, size_t basecase)
+      : newton(limbs::newton_threshold), basecase(limbs::newton_basecase_threshold) {
+    limbs::newton_threshold = newton;
+    limbs::newton_basecase_threshold = basecase;
+  }
+  ~newton_thresholds() {
+    limbs::newton_threshold = newton;
+    limbs::newton_basecase_threshold = basecase;
+  }
+
+  size_t newton;
+  size_t basecase;
+};
+}
+
+TEST(correctness_random, div_newton) {
+  // small thresholds take divisors of a few dozen limbs through the Newton iteration
+  std::default_random_engine rng(2718);
+  newton_thresholds small(4, 2);
+  for (size_t bits = 64 * 5; bits <= 64 * 400; bits += bits / 5) {
+    big_integer_gmp a, b;
+    a.random(bits * 3, rng);
+    b.random(bits, rng);
+    if (bits % 3 == 0)
+      b = (big_integer_gmp(1) << static_cast<int>(bits)) - big_integer_gmp(1);
+    if (bits % 2 != 0)
+      a = -a;
+    if (b == big_integer_gmp(0))
+      continue;
+    big_integer A(to_string(a)), B(to_string(b));
+    EXPECT_EQ(to_string(a / b), to_string(A / B));
+    EXPECT_EQ(to_string(a % b), to_string(A % B));
+
+    std::pair<big_integer, big_integer> qr = divmod(A, big_integer_reciprocal(B));
+    EXPECT_EQ(to_string(a / b), to_string(qr.first));
+    EXPECT_EQ(to_string(a % b), to_string(qr.second));
+  }
+}
+
+TEST(correctness_random, addmul_submul) {
+  std::default_random_engine rng(77);
+  for (size_t itn = 0; itn != number_of_iterations; ++itn) {
+    big_integer_gmp x, y, z;
+    x.random(max_size * 2, rng);
+    y.random(max_size / 4 + itn * max_size / 4, rng);
+    z.random(max_size, rng);
+    big_integer X(to_string(x)), Y(to_string(y)), Z(to_string(z));
+
+    big_integer R = X;
+    R.addmul(Y, Z);
+    EXPECT_EQ(to_string(x + y * z), to_string(R));
+    R = X;
+    R.submul(Y, Z);
+    EXPECT_EQ(to_string(x - y * z), to_string(R));
+    R = Y;
+    R.submul(Z, X);
+    EXPECT_EQ(to_string(y - z * x), to_string(R));
+  }
+}
+
+TEST(correctness_random, powmod) {
+  std::default_random_engine rng(2048);
+  for (size_t bits = 32; bits <= 2048 * 2; bits *= 2) {
+    for (size_t itn = 0; itn != 4; ++itn) {
+      big_integer_gmp a, e, m;
+      a.random(bits + 100, rng);
+      e.random(bits, rng);
+      m.random(bits, rng);
+      if (e < 0)
+        e = -e;
+      // odd and even moduli take different reductions
+      if (itn % 2 == 0)
+        m |= big_integer_gmp(1);
+      else
+        m <<= 3;
+      if (m == big_integer_gmp(0))
+        continue;
+      big_integer R = powmod(big_integer(to_string(a)), big_integer(to_string(e)), big_integer(to_string(m)));
+      EXPECT_EQ(to_string(powmod(a, e, m)), to_string(R));
+    }
+  }
+}
+
+namespace {
+// checks gcd, gcdext, lcm and modinv of a and b against each other and gcd against GMP
+void check_gcd(big_integer_gmp const& a, big_integer_gmp const& b) {
+  big_integer A(to_string(a)), B(to_string(b));
+  big_integer G = gcd(A, B);
+  EXPECT_EQ(to_string(gcd(a, b)), to_string(G));
+
+  auto [g, s, t] = gcdext(A, B);
+  EXPECT_EQ(G, g);
+  EXPECT_EQ(g, s * A + t * B);
+  if (B != 0) {
+    EXPECT_LE(2 * g * (s < 0 ? -s : s), B < 0 ? -B : B);
+  }
+
+  if (A != 0 && B != 0) {
+    EXPECT_EQ(lcm(A, B) * G, A * B < 0 ? -(A * B) : A * B);
+  }
+  if (G == 1 && B != 0) {
+    big_integer x = modinv(A, B);
+    EXPECT_EQ(0, (A * x - 1) % B);
+    EXPECT_LT(x, B < 0 ? -B : B);
+  }
+}
+
+// operands of up to max_bits with a random common factor every other time, and pairs of
+// consecutive Fibonacci numbers, whose quotients are all one
+void check_gcd_random(size_t max_bits, std::default_random_engine& rng) {
+  for (size_t bits = 64; bits <= max_bits; bits += bits / 2) {
+    for (size_t itn = 0; itn != 4; ++itn) {
+      big_integer_gmp a, b, c;
+      a.random(bits, rng);
+      b.random(bits - bits * itn / 8, rng);
+      if (itn % 2 == 1) {
+        c.random(bits / 2, rng);
+        a *= c;
+        b *= c;
+      }
+      check_gcd(a, b);
+      check_gcd(b, a);
+    }
+
+    big_integer_gmp f0(0), f1(1);
+    while (f1 < (big_integer_gmp(1) << static_cast<int>(bits))) {
+      big_integer_gmp f2 = f0 + f1;
+      f0 = f1;
+      f1 = f2;
+    }
+    check_gcd(f1, f0);
+  }
+}
+
+// lowers limbs::gcd_threshold and limbs::hgcd_threshold for its lifetime
+struct gcd_thresholds {
+  gcd_thresholds(size_t gcd, size_t hgcd) : gcd(limbs::gcd_threshold), hgcd(limbs::hgcd_threshold) {
+    limbs::gcd_threshold = gcd;
+    limbs::hgcd_threshold = hgcd;
+  }
+  ~gcd_thresholds() {
+    limbs::gcd_threshold = gcd;
+    limbs::hgcd_threshold = hgcd;
+  }
+
+  size_t gcd;
+  size_t hgcd;
+};
+}
+
+TEST(correctness_random, gcd) {
+  std::default_random_engine rng(6);
+  check_gcd_random(max_size * 2, rng);
+}
+
+TEST(correctness_random, gcd_half_gcd) {
+  // small thresholds take operands of a few dozen limbs through the recursion
+  std::default_random_engine rng(60);
+  gcd_thresholds small(8, 4);
+  check_gcd_random(64 * 60, rng);
+}
+
+TEST(correctness_random, roots) {
+  std::default_random_engine rng(81);
+  for (size_t bits = 16; bits <= max_size * 16; bits += bits / 2) {
+    for (unsigned long k = 2; k <= 7; ++k) {
+      big_integer_gmp a;
+      a.random(bits, rng);
+      if (k % 2 == 0 && a < 0)
+        a = -a;
+      big_integer r = iroot(big_integer(to_string(a)), k);
+      EXPECT_EQ(to_string(iroot(a, k)), to_string(r));
+      if (k == 2) {
+        EXPECT_EQ(r, isqrt(big_integer(to_string(a))));
+        EXPECT_TRUE(is_perfect_square(r * r));
+        EXPECT_EQ(r * r == big_integer(to_string(a)), is_perfect_square(big_integer(to_string(a))));
+        EXPECT_EQ(r == 0, is_perfect_square(r * r + 2 * r));
+      }
+    }
+  }
+}
+
+TEST(correctness_random, sum) {
+  std::default_random_engine rng(19);
+  for (size_t itn = 0; itn != number_of_iterations; ++itn) {
+    std::vector<big_integer> x;
+    big_integer_gmp expected(0);
+    for (size_t i = 0; i != number_of_multipliers; ++i) {
+      big_integer_gmp a;
+      a.random(rng() % (max_size * 4) + 1, rng);
+      expected += a;
+      x.emplace_back(to_string(a));
+    }
+    EXPECT_EQ(to_string(expected), to_string(sum(x.begin(), x.end())));
+
+    // the positive and negative parts cancel down to a few limbs
+    big_integer last = -sum(x.begin(), x.end() - 1) + 12345;
+    x.back() = last;
+    EXPECT_EQ(12345, sum(x.begin(), x.end()));
+  }
+}
+
+TEST(correctness_random, divmod_long) {
+  std::default_random_engine rng(322);
+  for (size_t itn = 0; itn != number_of_iterations; ++itn) {
+    big_integer_gmp a, b;
+    a.random(max_size * 32, rng);
+    b.random(max_size * 8 + itn * max_size, rng);
+    std::pair<big_integer, big_integer> qr = divmod(big_integer(to_string(a)), big_integer(to_string(b)));
+    EXPECT_EQ(to_string(a / b), to_string(qr.first));
+    EXPECT_EQ(to_string(a % b), to_string(qr.second));
+  }
+}
+
+TEST(correctness_random, divmod_reciprocal) {
+  std::default_random_engine rng(1337);
+  big_integer_gmp b;
+  b.random(max_size * 8, rng);
+  big_integer_reciprocal rb(big_integer(to_string(b)));
+  for (size_t itn = 0; itn != number_of_iterations; ++itn) {
+    big_integer_gmp a;
+    a.random(max_size * 8 + itn * max_size, rng);
+    std::pair<big_integer, big_integer> qr = divmod(big_integer(to_string(a)), rb);
+    EXPECT_EQ(to_string(a / b), to_string(qr.first));
+    EXPECT_EQ(to_string(a % b), to_string(qr.second));
+  }
+}
+
 TEST(correctness_random, bitwise) {
   std::default_random_engine rng(42);
   for (size_t itn = 0; itn != number_of_iterations; ++itn) {
@@ -809,6 +1895,33 @@ TEST(correctness_random, bit_shifts) {
   }
 }
 
+TEST(correctness_random, string_conv_long) {
+  std::default_random_engine rng(2024);
+  for (size_t itn = 0; itn != number_of_iterations; ++itn) {
+    big_integer_gmp a;
+    a.random(max_size * 8 + itn * max_size * 4, rng);
+    std::string s = to_string(a);
+    EXPECT_EQ(s, to_string(big_integer(s)));
+  }
+}
+
+TEST(correctness_random, string_conv_cached_powers) {
+  // long numbers first, so the shorter ones find more powers of ten cached than they use,
+  // on a thread of its own and on this one
+  auto check = [](unsigned seed) {
+    std::default_random_engine rng(seed);
+    for (size_t bits = 64 * 2000; bits >= 64; bits -= bits / 7 + 1) {
+      big_integer_gmp a;
+      a.random(bits, rng);
+      std::string s = to_string(a);
+      EXPECT_EQ(s, to_string(big_integer(s)));
+    }
+  };
+  std::thread t(check, 77);
+  t.join();
+  check(78);
+}
+
 // TODO: extend due to idea
 TEST(correctness_twos_complement, simple) {
   std::string a = "-36893488147419103232"; // -(1 << 65)
@@ -835,3 +1948,37 @@ TEST(correctness_twos_complement, all_ones) {
 
   EXPECT_EQ(to_string(gmp_ans), to_string(your_ans));
 }
+
+TEST(correctness_twos_complement, sign_combinations) {
+  // values around limb boundaries, where the on-the-fly borrows and carries run furthest
+  std::vector<std::string> values = {"0", "1", "18446744073709551615", "18446744073709551616",
+                                     "340282366920938463463374607431768211455", "12345678901234567890123"};
+  for (std::string const& x : values) {
+    for (std::string const& y : values) {
+      for (int signs = 0; signs != 4; ++signs) {
+        big_integer_gmp gmp_a(x), gmp_b(y);
+        if (signs & 1)
+          gmp_a = -gmp_a;
+        if (signs & 2)
+          gmp_b = -gmp_b;
+        big_integer a(to_string(gmp_a)), b(to_string(gmp_b));
+
+        EXPECT_EQ(to_string(gmp_a & gmp_b), to_string(a & b));
+        EXPECT_EQ(to_string(gmp_a | gmp_b), to_string(a | b));
+        EXPECT_EQ(to_string(gmp_a ^ gmp_b), to_string(a ^ b));
+        EXPECT_EQ(to_string(~gmp_a), to_string(~a));
+      }
+    }
+  }
+}
+
+TEST(correctness_twos_complement, self_aliasing) {
+  big_integer a("-340282366920938463463374607431768211456");
+  big_integer r = a;
+  r &= r;
+  EXPECT_EQ(a, r);
+  r |= r;
+  EXPECT_EQ(a, r);
+  r ^= r;
+  EXPECT_EQ(0, r);
+}
@@ -0,0 +1,126 @@
+#include "limb_pool.h"
+#include "limbs.h"
+
+#include <new>
+
+namespace
+{
+size_t const classes = 11;
+static_assert(limb_pool::min_block << (classes - 1) == limb_pool::max_block, "one class for each power of two");
+
+struct free_block
+{
+    free_block* next;
+};
+
+struct pool
+{
+    ~pool();
+    void clear() noexcept;
+
+    free_block* lists[classes] = {};
+    size_t cached[classes] = {};
+    limb_pool::statistics stats = {};
+};
+
+// set once the calling thread's pool is destroyed at its exit; buffers freed later, say by
+// static objects on the main thread, go straight to operator delete
+thread_local bool pool_gone = false;
+
+pool& local_pool()
+{
+    thread_local pool p;
+    return p;
+}
+
+pool::~pool()
+{
+    clear();
+    pool_gone = true;
+}
+
+void pool::clear() noexcept
+{
+    for (size_t c = 0; c != classes; ++c)
+    {
+        while (free_block* b = lists[c])
+        {
+            lists[c] = b->next;
+            ::operator delete(b);
+        }
+        cached[c] = 0;
+    }
+    stats.cached_bytes = 0;
+}
+
+size_t class_of(size_t bytes)
+{
+    if (bytes <= limb_pool::min_block)
+        return 0;
+    return limbs::limb_bits - limbs::count_leading_zeros((bytes - 1) / limb_pool::min_block);
+}
+}
+
+namespace limb_pool
+{
+size_t block_size(size_t bytes)
+{
+    return bytes > max_block ? bytes : min_block << class_of(bytes);
+}
+
+void* allocate(size_t bytes)
+{
+    if (pool_gone)
+        return ::operator new(block_size(bytes));
+    pool& p = local_pool();
+    ++p.stats.allocations;
+    if (bytes > max_block)
+    {
+        ++p.stats.large;
+        return ::operator new(bytes);
+    }
+    size_t c = class_of(bytes);
+    if (free_block* b = p.lists[c])
+    {
+        p.lists[c] = b->next;
+        p.cached[c] -= min_block << c;
+        p.stats.cached_bytes -= min_block << c;
+        ++p.stats.reuses;
+        return b;
+    }
+    return ::operator new(min_block << c);
+}
+
+void deallocate(void* ptr, size_t bytes) noexcept
+{
+    if (pool_gone)
+    {
+        ::operator delete(ptr);
+        return;
+    }
+    pool& p = local_pool();
+    ++p.stats.deallocations;
+    size_t c = bytes > max_block ? 0 : class_of(bytes);
+    if (bytes > max_block || p.cached[c] + (min_block << c) > max_cached_bytes)
+    {
+        ::operator delete(ptr);
+        return;
+    }
+    free_block* b = static_cast<free_block*>(ptr);
+    b->next = p.lists[c];
+    p.lists[c] = b;
+    p.cached[c] += min_block << c;
+    p.stats.cached_bytes += min_block << c;
+}
+
+statistics thread_statistics()
+{
+    return pool_gone ? statistics{} : local_pool().stats;
+}
+
+void release_cached() noexcept
+{
+    if (!pool_gone)
+        local_pool().clear();
+}
+}
@@ -0,0 +1,44 @@
+#ifndef LIMB_POOL_H
+#define LIMB_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Thread-local size-class free lists for limb buffers. A request is rounded up to a power of
+// two from min_block to max_block bytes and served from the calling thread's list for that
+// size, so a freed buffer comes back to the next request of its class without reaching
+// malloc; larger requests go to operator new. A buffer may be freed on any thread and then
+// joins that thread's lists, each of which keeps at most max_cached_bytes.
+// limb_storage allocates through here when BIG_INTEGER_POOL is defined.
+namespace limb_pool
+{
+size_t const min_block = 64;
+size_t const max_block = 64 * 1024;
+size_t const max_cached_bytes = 1024 * 1024;
+
+// counters of the calling thread since it started
+struct statistics
+{
+    // calls to allocate, and those of them served from a free list
+    uint64_t allocations;
+    uint64_t reuses;
+    // calls to allocate above max_block, which went to operator new
+    uint64_t large;
+    uint64_t deallocations;
+    // bytes held in the free lists now
+    size_t cached_bytes;
+};
+
+// the size allocate(bytes) actually hands out, which the caller may use in full
+size_t block_size(size_t bytes);
+
+void* allocate(size_t bytes);
+// bytes as passed to allocate or as returned by block_size for it
+void deallocate(void* p, size_t bytes) noexcept;
+
+statistics thread_statistics();
+// returns the free lists of the calling thread to operator delete
+void release_cached() noexcept;
+}
+
+#endif // LIMB_POOL_H
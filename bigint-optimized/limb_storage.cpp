@@ -0,0 +1,258 @@
+#include "limb_storage.h"
+#include "big_integer_arena.h"
+#ifdef BIG_INTEGER_POOL
+#include "limb_pool.h"
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+namespace
+{
+typedef limb_storage::value_type limb_t;
+
+// the header of a heap or arena buffer, after which the limbs are 8-aligned
+size_t const header_size = 16;
+
+// a block for at least n limbs, with n raised to all the block holds
+char* allocate_block(size_t& n)
+{
+#ifdef BIG_INTEGER_POOL
+    size_t bytes = limb_pool::block_size(header_size + n * sizeof(limb_t));
+    n = (bytes - header_size) / sizeof(limb_t);
+    return static_cast<char*>(limb_pool::allocate(bytes));
+#else
+    return static_cast<char*>(::operator new(header_size + n * sizeof(limb_t)));
+#endif
+}
+
+void deallocate_block(char* block, size_t n) noexcept
+{
+#ifdef BIG_INTEGER_POOL
+    limb_pool::deallocate(block, header_size + n * sizeof(limb_t));
+#else
+    (void)n;
+    ::operator delete(block);
+#endif
+}
+}
+
+limb_storage::limb_storage() noexcept
+    : length(0)
+    , kind(inline_buffer)
+    , birth(static_cast<uint16_t>(std::min<size_t>(big_integer_arena::depth(), no_arena)))
+{}
+
+limb_storage::limb_storage(size_t n)
+    : limb_storage()
+{
+    resize(n);
+}
+
+limb_storage::limb_storage(size_t n, value_type value)
+    : limb_storage()
+{
+    assign(n, value);
+}
+
+limb_storage::limb_storage(limb_storage const& other)
+    : limb_storage()
+{
+    if (other.in_arena())
+    {
+        // a copy may be headed out of the scope, say into an outer container, so it takes
+        // its limbs to the heap
+        copy_out(other);
+        return;
+    }
+    length = other.length;
+    kind = other.kind;
+    std::memcpy(local, other.local, sizeof(local));
+    if (!is_inline())
+    {
+#ifdef BIG_INTEGER_SINGLE_THREADED
+        ++head().refs;
+#else
+        head().refs.fetch_add(1, std::memory_order_relaxed);
+#endif
+    }
+}
+
+limb_storage::limb_storage(limb_storage&& other)
+    : limb_storage()
+{
+    if (other.in_arena())
+    {
+        // a value made in an arena leaves it by a move, say when it is returned from the
+        // scope, so its limbs are copied to the heap
+        copy_out(other);
+        other.release();
+        return;
+    }
+    length = other.length;
+    kind = other.kind;
+    std::memcpy(local, other.local, sizeof(local));
+    other.length = 0;
+    other.kind = inline_buffer;
+}
+
+limb_storage::~limb_storage()
+{
+    release();
+}
+
+limb_storage& limb_storage::operator=(limb_storage const& other)
+{
+    limb_storage tmp(other);
+    swap(tmp);
+    return *this;
+}
+
+limb_storage& limb_storage::operator=(limb_storage&& other)
+{
+    if (this != &other && other.in_arena() && other.birth == birth)
+    {
+        // made in the same arena, so the buffer may change hands
+        swap(other);
+        other.release();
+        return *this;
+    }
+    limb_storage tmp(std::move(other));
+    swap(tmp);
+    return *this;
+}
+
+void limb_storage::resize(size_t n)
+{
+    if (n > capacity() || shared())
+        grow(n > capacity() ? std::max(n, 2 * capacity()) : capacity());
+    if (n > length)
+        std::fill(data() + length, data() + n, limb_t(0));
+    length = static_cast<uint32_t>(n);
+}
+
+void limb_storage::reserve(size_t n)
+{
+    if (n > capacity())
+        grow(n);
+}
+
+void limb_storage::assign(size_t n, value_type value)
+{
+    if (shared())
+        release();
+    reserve(n);
+    std::fill(data(), data() + n, value);
+    length = static_cast<uint32_t>(n);
+}
+
+void limb_storage::assign(value_type const* first, value_type const* last)
+{
+    size_t n = static_cast<size_t>(last - first);
+    if (n > capacity() || shared())
+    {
+        // built before the old buffer goes, which the source may lie in, and in the arena
+        // of this object
+        limb_storage r;
+        r.birth = birth;
+        r.reserve(n);
+        std::copy(first, last, r.data());
+        r.length = static_cast<uint32_t>(n);
+        swap(r);
+        return;
+    }
+    std::memmove(data(), first, n * sizeof(limb_t));
+    length = static_cast<uint32_t>(n);
+}
+
+void limb_storage::swap(limb_storage& other)
+{
+    std::swap(length, other.length);
+    std::swap(kind, other.kind);
+    value_type t[inline_capacity];
+    std::memcpy(t, local, sizeof(local));
+    std::memcpy(local, other.local, sizeof(local));
+    std::memcpy(other.local, t, sizeof(local));
+    // the births stay, so an arena buffer that changed hands may now belong to an object
+    // made outside its arena
+    if (birth != other.birth)
+    {
+        leave_arena();
+        other.leave_arena();
+    }
+}
+
+void limb_storage::copy_out(limb_storage const& other)
+{
+    if (other.length > inline_capacity)
+        grow(other.length, false);
+    std::copy(other.heap, other.heap + other.length, data());
+    length = other.length;
+}
+
+void limb_storage::leave_arena()
+{
+    if (in_arena())
+        grow(capacity(), false);
+}
+
+void limb_storage::unshare()
+{
+    grow(capacity());
+}
+
+void limb_storage::release() noexcept
+{
+    if (kind == arena_buffer)
+    {
+        big_integer_arena::deallocate(reinterpret_cast<char*>(heap) - header_size);
+    }
+    else if (kind == heap_buffer)
+    {
+#ifdef BIG_INTEGER_SINGLE_THREADED
+        bool last = --head().refs == 0;
+#else
+        bool last = head().refs.fetch_sub(1, std::memory_order_acq_rel) == 1;
+#endif
+        if (last)
+        {
+            size_t n = head().capacity;
+            head().~header();
+            deallocate_block(reinterpret_cast<char*>(heap) - header_size, n);
+        }
+    }
+    length = 0;
+    kind = inline_buffer;
+}
+
+void limb_storage::grow(size_t n, bool use_arena)
+{
+    static_assert(sizeof(header) == header_size, "the header keeps the limbs 8-aligned");
+    if (n > max_size())
+        throw std::length_error("big_integer is too long");
+    char* block;
+    uint16_t k;
+    big_integer_arena* arena = big_integer_arena::current();
+    if (use_arena && arena != nullptr && birth != no_arena && birth == big_integer_arena::depth())
+    {
+        block = static_cast<char*>(arena->allocate(header_size + n * sizeof(limb_t)));
+        k = arena_buffer;
+    }
+    else
+    {
+        block = allocate_block(n);
+        k = heap_buffer;
+    }
+    new (block) header{n, {1}};
+    limb_t* p = reinterpret_cast<limb_t*>(block + header_size);
+    size_t keep = length;
+    limb_t const* old = is_inline() ? local : heap;
+    std::copy(old, old + keep, p);
+    release();
+    heap = p;
+    length = static_cast<uint32_t>(keep);
+    kind = k;
+}
@@ -0,0 +1,251 @@
+#ifndef LIMB_STORAGE_H
+#define LIMB_STORAGE_H
+
+#include <cstddef>
+#include <cstdint>
+#ifndef BIG_INTEGER_SINGLE_THREADED
+#include <atomic>
+#endif
+
+// The limbs of a big_integer: the part of the std::vector interface big_integer uses, over a
+// buffer that keeps up to inline_capacity limbs inside the object and moves to the heap only
+// once it grows past them, so values of up to 128 bits never allocate. The object holds no
+// pointer into itself and can be swapped bytewise; a pointer to the limbs of an inline buffer
+// follows the object, though, not the contents, when they are moved or swapped.
+//
+// Heap buffers are reference counted and copied on write: a copy shares the buffer, and the
+// first non-const access to the limbs of a shared one (data(), operator[], back(), begin(),
+// end() and every resizing call) gives the object a buffer of its own first. A pointer or
+// reference obtained that way is therefore only good until the object is copied. The count is
+// atomic unless BIG_INTEGER_SINGLE_THREADED is defined, which makes it a plain integer for
+// builds where values never cross threads.
+//
+// Objects made while a big_integer_arena is the innermost one on the thread take their new
+// buffers from it, and only from it: an object made outside grows on the heap and copies the
+// limbs of an arena buffer it would receive through a swap or a move. Arena buffers are never
+// shared; a copy of one, and an object moved from one, get heap buffers of their own. Those
+// copies make moves and swaps of arena values allocate, and as big_integer moves and swaps are
+// noexcept, running out of memory there ends the program. An arena buffer goes back to its
+// arena chunk when released, which keeps the chunk alive after the arena ends if need be.
+struct limb_storage
+{
+    typedef uint64_t value_type;
+    typedef value_type* iterator;
+    typedef value_type const* const_iterator;
+
+    // with the 32-bit size and the buffer kind and birth in 32 bits more this is 24 bytes,
+    // which leaves a big_integer with its sign at 32
+    static constexpr size_t inline_capacity = 2;
+
+    limb_storage() noexcept;
+    explicit limb_storage(size_t n);
+    limb_storage(size_t n, value_type value);
+    limb_storage(limb_storage const& other);
+    limb_storage(limb_storage&& other);
+    ~limb_storage();
+
+    limb_storage& operator=(limb_storage const& other);
+    limb_storage& operator=(limb_storage&& other);
+
+    size_t size() const noexcept;
+    bool empty() const noexcept;
+    size_t capacity() const noexcept;
+    size_t max_size() const noexcept;
+
+    value_type* data();
+    value_type const* data() const noexcept;
+    value_type& operator[](size_t i);
+    value_type const& operator[](size_t i) const noexcept;
+    value_type& back();
+    value_type const& back() const noexcept;
+    iterator begin();
+    const_iterator begin() const noexcept;
+    iterator end();
+    const_iterator end() const noexcept;
+
+    void clear() noexcept;
+    void pop_back() noexcept;
+    void push_back(value_type x);
+    // new limbs are zero
+    void resize(size_t n);
+    void reserve(size_t n);
+    void assign(size_t n, value_type value);
+    // [first, last) may lie in this buffer
+    void assign(value_type const* first, value_type const* last);
+
+    void swap(limb_storage& other);
+
+private:
+#ifdef BIG_INTEGER_SINGLE_THREADED
+    typedef size_t refcount_t;
+#else
+    typedef std::atomic<size_t> refcount_t;
+#endif
+
+    // in front of the limbs of heap and arena buffers; an arena buffer has no count
+    struct header
+    {
+        size_t capacity;
+        refcount_t refs;
+    };
+
+    enum : uint16_t
+    {
+        inline_buffer,
+        heap_buffer,
+        arena_buffer
+    };
+
+    // birth of objects made with no arena, or under more than fit in it
+    static constexpr uint16_t no_arena = 0xffff;
+
+    bool is_inline() const noexcept;
+    bool in_arena() const noexcept;
+    header& head() const noexcept;
+    bool shared() const noexcept;
+    // gives a shared heap buffer its own copy of the limbs, of the same capacity
+    void unshare();
+    // drops the reference to a heap or arena buffer, leaving the object empty and inline
+    void release() noexcept;
+    // moves the limbs to a buffer of its own of at least n limbs, n > capacity() or the
+    // current one shared; from the arena if the object was made in the innermost one
+    // and use_arena is set
+    void grow(size_t n, bool use_arena = true);
+    // the limbs of other, an arena buffer, in an empty inline object, on the heap
+    void copy_out(limb_storage const& other);
+    // moves limbs received from an arena the object was not made in to the heap
+    void leave_arena();
+
+    uint32_t length;
+    uint16_t kind;
+    // the depth of the arena that was innermost when the object was made, which is the one
+    // an arena buffer of the object comes from
+    uint16_t birth;
+    union
+    {
+        value_type local[inline_capacity];
+        value_type* heap;
+    };
+};
+
+inline bool limb_storage::is_inline() const noexcept
+{
+    return kind == inline_buffer;
+}
+
+inline bool limb_storage::in_arena() const noexcept
+{
+    return kind == arena_buffer;
+}
+
+inline limb_storage::header& limb_storage::head() const noexcept
+{
+    return reinterpret_cast<header*>(heap)[-1];
+}
+
+inline bool limb_storage::shared() const noexcept
+{
+#ifdef BIG_INTEGER_SINGLE_THREADED
+    return kind == heap_buffer && head().refs != 1;
+#else
+    return kind == heap_buffer && head().refs.load(std::memory_order_acquire) != 1;
+#endif
+}
+
+inline size_t limb_storage::size() const noexcept
+{
+    return length;
+}
+
+inline bool limb_storage::empty() const noexcept
+{
+    return length == 0;
+}
+
+inline size_t limb_storage::capacity() const noexcept
+{
+    return is_inline() ? inline_capacity : head().capacity;
+}
+
+inline size_t limb_storage::max_size() const noexcept
+{
+    return UINT32_MAX;
+}
+
+inline limb_storage::value_type* limb_storage::data()
+{
+    if (is_inline())
+        return local;
+    if (shared())
+        unshare();
+    return heap;
+}
+
+inline limb_storage::value_type const* limb_storage::data() const noexcept
+{
+    return is_inline() ? local : heap;
+}
+
+inline limb_storage::value_type& limb_storage::operator[](size_t i)
+{
+    return data()[i];
+}
+
+inline limb_storage::value_type const& limb_storage::operator[](size_t i) const noexcept
+{
+    return data()[i];
+}
+
+inline limb_storage::value_type& limb_storage::back()
+{
+    return data()[length - 1];
+}
+
+inline limb_storage::value_type const& limb_storage::back() const noexcept
+{
+    return data()[length - 1];
+}
+
+inline limb_storage::iterator limb_storage::begin()
+{
+    return data();
+}
+
+inline limb_storage::const_iterator limb_storage::begin() const noexcept
+{
+    return data();
+}
+
+inline limb_storage::iterator limb_storage::end()
+{
+    return data() + length;
+}
+
+inline limb_storage::const_iterator limb_storage::end() const noexcept
+{
+    return data() + length;
+}
+
+inline void limb_storage::clear() noexcept
+{
+    length = 0;
+}
+
+inline void limb_storage::pop_back() noexcept
+{
+    --length;
+}
+
+inline void limb_storage::push_back(value_type x)
+{
+    if (length == capacity())
+        grow(2 * capacity());
+    data()[length++] = x;
+}
+
+inline void swap(limb_storage& a, limb_storage& b)
+{
+    a.swap(b);
+}
+
+#endif // LIMB_STORAGE_H
@@ -0,0 +1,203 @@
+#include "limbs.h"
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+namespace limbs
+{
+size_t bz_threshold = 80;
+size_t newton_threshold = 1 << 20;
+size_t newton_basecase_threshold = 64;
+
+namespace
+{
+// Knuth, TAOCP vol. 2, 4.3.1, algorithm D.
+// v is normalized (top bit set), vn >= 2, and the top vn limbs of u are less than v.
+// q[0, un - vn) gets the quotient, u[0, vn) the remainder, the rest of u is zeroed.
+void divrem_basecase(limb_t* q, limb_t* u, size_t un, limb_t const* v, size_t vn)
+{
+    limb_t v1 = v[vn - 1];
+    limb_t v2 = v[vn - 2];
+    for (size_t j = un - vn; j-- != 0;)
+    {
+        dlimb_t num = (dlimb_t(u[j + vn]) << limb_bits) | u[j + vn - 1];
+        dlimb_t qhat = num / v1;
+        dlimb_t rhat = num % v1;
+        while ((qhat >> limb_bits) != 0 || qhat * v2 > ((rhat << limb_bits) | u[j + vn - 2]))
+        {
+            --qhat;
+            rhat += v1;
+            if ((rhat >> limb_bits) != 0)
+                break;
+        }
+
+        limb_t qd = static_cast<limb_t>(qhat);
+        limb_t borrow = submul_1(u + j, v, vn, qd);
+        limb_t top = u[j + vn];
+        u[j + vn] = top - borrow;
+        if (top < borrow)
+        {
+            --qd;
+            u[j + vn] += add_n(u + j, u + j, v, vn);
+        }
+        q[j] = qd;
+    }
+}
+
+void div_2n_1n(limb_t* q, limb_t* a, limb_t const* b, size_t n, limb_t* scratch);
+
+// Burnikel, Ziegler, "Fast Recursive Division", algorithm 2.
+// a[0, 3h) / b[0, 2h) where the top 2h limbs of a are less than b:
+// q[0, h) gets the quotient, a[0, 2h) the remainder.
+void div_3h_2h(limb_t* q, limb_t* a, limb_t const* b, size_t h, limb_t* scratch)
+{
+    limb_t const* b1 = b + h;
+    limb_t const* b2 = b;
+    limb_t* d = scratch;
+
+    long long top = 0;
+    if (cmp(a + 2 * h, b1, h) < 0)
+    {
+        div_2n_1n(q, a + h, b1, h, d + 2 * h);
+    }
+    else
+    {
+        // the top half of a equals b1, so the quotient digit is B^h - 1
+        // and the partial remainder is a - (B^h - 1) b1 B^h
+        std::fill(q, q + h, limb_max);
+        sub_n(a + 2 * h, a + 2 * h, b1, h);
+        top += static_cast<long long>(add(a + h, a + h, 2 * h, b1, h));
+    }
+
+    mul(d, q, h, b2, h);
+    top -= static_cast<long long>(sub(a, a, 3 * h, d, 2 * h));
+    // at most two corrections
+    while (top < 0)
+    {
+        sub_1(q, q, h, 1);
+        top += static_cast<long long>(add(a, a, 3 * h, b, 2 * h));
+    }
+}
+
+// a[0, 2n) / b[0, n) where b is normalized and the top n limbs of a are less than b:
+// q[0, n) gets the quotient, a[0, n) the remainder.
+void div_2n_1n(limb_t* q, limb_t* a, limb_t const* b, size_t n, limb_t* scratch)
+{
+    if (n % 2 != 0 || n <= bz_threshold)
+    {
+        divrem_basecase(q, a, 2 * n, b, n);
+        return;
+    }
+    size_t h = n / 2;
+    div_3h_2h(q + h, a + h, b, h, scratch);
+    div_3h_2h(q, a, b, h, scratch);
+}
+
+// same contract as divrem_basecase, by blocks of div_2n_1n
+void divrem_recursive(limb_t* q, limb_t* u, size_t un, limb_t const* v, size_t vn)
+{
+    // pad the divisor with low zero limbs up to m 2^k limbs, m <= bz_threshold,
+    // so that every level of the recursion splits evenly
+    size_t m = vn;
+    unsigned k = 0;
+    while (m > bz_threshold)
+    {
+        m = (m + 1) / 2;
+        ++k;
+    }
+    size_t n = m << k;
+    size_t pad = n - vn;
+    size_t blocks = std::max<size_t>(2, (un + pad + n - 1) / n);
+
+    std::vector<limb_t> buffer(blocks * n + n + (blocks - 1) * n + 2 * n);
+    limb_t* x = buffer.data();
+    limb_t* y = x + blocks * n;
+    limb_t* quotient = y + n;
+    limb_t* scratch = quotient + (blocks - 1) * n;
+    std::copy(u, u + un, x + pad);
+    std::copy(v, v + vn, y + pad);
+
+    for (size_t i = blocks - 1; i-- != 0;)
+        div_2n_1n(quotient + i * n, x + i * n, y, n, scratch);
+
+    assert(normalized_size(quotient, (blocks - 1) * n) <= un - vn);
+    std::copy(quotient, quotient + (un - vn), q);
+    std::copy(x + pad, x + pad + vn, u);
+    std::fill(u + vn, u + un, limb_t(0));
+}
+}
+
+limb_t divrem_1(limb_t* q, limb_t const* a, size_t n, limb_t d)
+{
+    assert(d != 0);
+    limb_t rem = 0;
+    while (n-- != 0)
+    {
+        dlimb_t cur = (dlimb_t(rem) << limb_bits) | a[n];
+        q[n] = static_cast<limb_t>(cur / d);
+        rem = static_cast<limb_t>(cur % d);
+    }
+    return rem;
+}
+
+limb_t mod_1(limb_t const* a, size_t n, limb_t d)
+{
+    assert(d != 0);
+    limb_t rem = 0;
+    while (n-- != 0)
+        rem = static_cast<limb_t>(((dlimb_t(rem) << limb_bits) | a[n]) % d);
+    return rem;
+}
+
+void redc(limb_t* r, limb_t* t, limb_t const* m, size_t n, limb_t minv)
+{
+    // each step clears t[i]; its carry out belongs at t[i + n] but is parked in t[i] and
+    // added in one pass at the end, which no later quotient limb depends on
+    for (size_t i = 0; i != n; ++i)
+        t[i] = addmul_1(t + i, m, n, t[i] * minv);
+    // t / B^n < 2m, so one subtraction brings it below m
+    limb_t carry = add_n(r, t + n, t, n);
+    if (carry != 0 || cmp(r, m, n) >= 0)
+        sub_n(r, r, m, n);
+}
+
+void divrem(limb_t* q, limb_t* r, limb_t const* a, size_t an, limb_t const* b, size_t bn)
+{
+    assert(an >= bn && bn >= 1 && b[bn - 1] != 0);
+
+    if (bn == 1)
+    {
+        r[0] = divrem_1(q, a, an, b[0]);
+        return;
+    }
+
+    // normalize so that the divisor has its top bit set; the extra limb on top of u
+    // is less than that top bit, which keeps the top bn limbs of u below v
+    unsigned shift = count_leading_zeros(b[bn - 1]);
+    std::vector<limb_t> scratch(an + 1 + bn);
+    limb_t* u = scratch.data();
+    limb_t* v = u + an + 1;
+    if (shift != 0)
+    {
+        u[an] = lshift(u, a, an, shift);
+        lshift(v, b, bn, shift);
+    }
+    else
+    {
+        u[an] = 0;
+        std::copy(a, a + an, u);
+        std::copy(b, b + bn, v);
+    }
+
+    if (bn > bz_threshold && an - bn > bz_threshold)
+        divrem_recursive(q, u, an + 1, v, bn);
+    else
+        divrem_basecase(q, u, an + 1, v, bn);
+
+    if (shift != 0)
+        rshift(r, u, bn, shift);
+    else
+        std::copy(u, u + bn, r);
+}
+}
@@ -0,0 +1,64 @@
+#include "limbs.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace limbs
+{
+size_t gcd_threshold = 3000;
+size_t hgcd_threshold = 192;
+
+limb_t gcd_1(limb_t a, limb_t b)
+{
+    if (a == 0)
+        return b;
+    if (b == 0)
+        return a;
+    // binary gcd: the common power of two is set aside, then odd values are subtracted
+    unsigned shift = count_trailing_zeros(a | b);
+    a >>= count_trailing_zeros(a);
+    while (b != 0)
+    {
+        b >>= count_trailing_zeros(b);
+        if (a > b)
+            std::swap(a, b);
+        b -= a;
+    }
+    return a << shift;
+}
+
+size_t hgcd2(dlimb_t x, dlimb_t y, dlimb_t ymin, bool exact, limb_t (&u)[2], limb_t (&v)[2])
+{
+    assert(x >= y);
+    u[0] = 1;
+    v[0] = 0;
+    u[1] = 0;
+    v[1] = 1;
+    // a cofactor after a step is at most x0 / y, so it fits in a limb while y >= x0 / B
+    dlimb_t const ybound = std::max<dlimb_t>(std::max<dlimb_t>(ymin, x >> limb_bits), 1);
+    size_t k = 0;
+    while (y >= ybound)
+    {
+        dlimb_t q = x / y;
+        dlimb_t r = x - q * y;
+        dlimb_t nu = q * u[1] + u[0];
+        dlimb_t nv = q * v[1] + v[0];
+        if ((nu >> limb_bits) != 0 || (nv >> limb_bits) != 0)
+            break;
+        // Jebelean's condition, on both cofactor sequences: the quotient of the leading bits
+        // is the quotient of the full numbers as long as r >= |cofactor| and y - r >= the
+        // difference of consecutive cofactors
+        if (!exact && (r < std::max(nu, nv) || y - r < std::max(nu + u[1], nv + v[1])))
+            break;
+
+        x = y;
+        y = r;
+        u[0] = u[1];
+        v[0] = v[1];
+        u[1] = static_cast<limb_t>(nu);
+        v[1] = static_cast<limb_t>(nv);
+        ++k;
+    }
+    return k;
+}
+}
@@ -0,0 +1,259 @@
+#include "limbs.h"
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+// Multiplication by number-theoretic transform: every limb is one coefficient, the cyclic
+// convolution is computed modulo three primes below 2^62 and recombined with Garner's CRT.
+// The primes multiply to about 2^183.7, so a coefficient of the product, at most
+// n (B - 1)^2 < n 2^128, is recovered exactly while n < 2^55.7; the second prime already
+// limits transforms to 2^55 points.
+namespace limbs
+{
+size_t ntt_threshold = 16000;
+
+namespace
+{
+limb_t pow_mod(limb_t a, limb_t e, limb_t p)
+{
+    limb_t r = 1;
+    for (; e != 0; e >>= 1)
+    {
+        if (e & 1)
+            r = static_cast<limb_t>(dlimb_t(r) * a % p);
+        a = static_cast<limb_t>(dlimb_t(a) * a % p);
+    }
+    return r;
+}
+
+struct prime_field
+{
+    prime_field(limb_t p, limb_t generator, unsigned max_log)
+        : p(p)
+        , generator(generator)
+        , max_log(max_log)
+        , pinv(p)
+    {
+        // Newton iteration doubles the number of correct low bits every step
+        for (int i = 0; i != 5; ++i)
+            pinv *= 2 - p * pinv;
+        limb_t r = static_cast<limb_t>((dlimb_t(1) << limb_bits) % p);
+        r2 = static_cast<limb_t>(dlimb_t(r) * r % p);
+    }
+
+    limb_t add(limb_t a, limb_t b) const
+    {
+        limb_t s = a + b;
+        return s >= p ? s - p : s;
+    }
+
+    limb_t sub(limb_t a, limb_t b) const
+    {
+        return a >= b ? a - b : a - b + p;
+    }
+
+    // Montgomery product a * b / B mod p
+    limb_t mul(limb_t a, limb_t b) const
+    {
+        dlimb_t t = dlimb_t(a) * b;
+        limb_t m = static_cast<limb_t>(t) * pinv;
+        limb_t hi = static_cast<limb_t>(t >> limb_bits);
+        limb_t mp = static_cast<limb_t>((dlimb_t(m) * p) >> limb_bits);
+        return hi >= mp ? hi - mp : hi - mp + p;
+    }
+
+    limb_t to_montgomery(limb_t a) const
+    {
+        return mul(a % p, r2);
+    }
+
+    limb_t p;
+    limb_t generator;
+    unsigned max_log;
+    limb_t pinv;
+    limb_t r2;
+};
+
+prime_field const& prime(size_t i)
+{
+    static prime_field const primes[3] = {
+        prime_field(4179340454199820289ULL, 3, 57), // 29 * 2^57 + 1
+        prime_field(2485986994308513793ULL, 5, 55), // 69 * 2^55 + 1
+        prime_field(1945555039024054273ULL, 5, 56), // 27 * 2^56 + 1
+    };
+    return primes[i];
+}
+
+// roots[len + j] = w^j for the primitive 2 len-th root of unity w (or its inverse), in Montgomery form
+void fill_roots(limb_t* roots, size_t n, prime_field const& f, bool inverse)
+{
+    for (size_t len = 1; len < n; len *= 2)
+    {
+        limb_t w = pow_mod(f.generator, (f.p - 1) / (2 * len), f.p);
+        if (inverse)
+            w = pow_mod(w, f.p - 2, f.p);
+        limb_t step = f.to_montgomery(w);
+        limb_t cur = f.to_montgomery(1);
+        for (size_t j = 0; j != len; ++j)
+        {
+            roots[len + j] = cur;
+            cur = f.mul(cur, step);
+        }
+    }
+}
+
+// decimation in frequency: natural order in, bit-reversed order out
+void forward(limb_t* a, size_t n, prime_field const& f, limb_t const* roots)
+{
+    for (size_t len = n / 2; len != 0; len /= 2)
+    {
+        for (size_t start = 0; start != n; start += 2 * len)
+        {
+            limb_t* x = a + start;
+            limb_t* y = x + len;
+            for (size_t j = 0; j != len; ++j)
+            {
+                limb_t u = x[j];
+                limb_t v = y[j];
+                x[j] = f.add(u, v);
+                y[j] = f.mul(f.sub(u, v), roots[len + j]);
+            }
+        }
+    }
+}
+
+// decimation in time: bit-reversed order in, natural order out, not scaled by 1 / n
+void inverse(limb_t* a, size_t n, prime_field const& f, limb_t const* roots)
+{
+    for (size_t len = 1; len < n; len *= 2)
+    {
+        for (size_t start = 0; start != n; start += 2 * len)
+        {
+            limb_t* x = a + start;
+            limb_t* y = x + len;
+            for (size_t j = 0; j != len; ++j)
+            {
+                limb_t u = x[j];
+                limb_t v = f.mul(y[j], roots[len + j]);
+                x[j] = f.add(u, v);
+                y[j] = f.sub(u, v);
+            }
+        }
+    }
+}
+
+void load(limb_t* x, size_t n, limb_t const* a, size_t an, prime_field const& f)
+{
+    for (size_t i = 0; i != an; ++i)
+        x[i] = a[i] % f.p;
+    std::fill(x + an, x + n, limb_t(0));
+}
+
+// x = a * b (or a * a when b is null) modulo f.p as plain residues
+void convolve(limb_t* x, limb_t* work, limb_t* roots, size_t n, prime_field const& f,
+              limb_t const* a, size_t an, limb_t const* b, size_t bn)
+{
+    fill_roots(roots, n, f, false);
+    load(x, n, a, an, f);
+    forward(x, n, f, roots);
+    if (b != nullptr)
+    {
+        load(work, n, b, bn, f);
+        forward(work, n, f, roots);
+        for (size_t i = 0; i != n; ++i)
+            x[i] = f.mul(x[i], work[i]);
+    }
+    else
+    {
+        for (size_t i = 0; i != n; ++i)
+            x[i] = f.mul(x[i], x[i]);
+    }
+
+    fill_roots(roots, n, f, true);
+    inverse(x, n, f, roots);
+
+    // the pointwise Montgomery product left a factor of 1 / B, so scale by B^2 / n
+    limb_t scale = pow_mod(n % f.p, f.p - 2, f.p);
+    scale = f.mul(f.mul(scale, f.r2), f.r2);
+    for (size_t i = 0; i != n; ++i)
+        x[i] = f.mul(x[i], scale);
+}
+
+// r[0, rn) = sum x_i B^i where x_i is given by its residues modulo the three primes
+void recombine(limb_t* r, size_t rn, limb_t const* x1, limb_t const* x2, limb_t const* x3)
+{
+    prime_field const& f1 = prime(0);
+    prime_field const& f2 = prime(1);
+    prime_field const& f3 = prime(2);
+    limb_t const p1 = f1.p;
+    limb_t const p2 = f2.p;
+    // constants in Montgomery form, so that f.mul by them is a plain modular product
+    limb_t const p1_inv_mod_p2 = f2.to_montgomery(pow_mod(p1 % p2, p2 - 2, p2));
+    limb_t const p1_mod_p3 = f3.to_montgomery(p1 % f3.p);
+    limb_t const p1p2_inv_mod_p3 = f3.to_montgomery(
+            pow_mod(static_cast<limb_t>(dlimb_t(p1 % f3.p) * (p2 % f3.p) % f3.p), f3.p - 2, f3.p));
+    dlimb_t const p1p2 = dlimb_t(p1) * p2;
+    limb_t const p1p2_lo = static_cast<limb_t>(p1p2);
+    limb_t const p1p2_hi = static_cast<limb_t>(p1p2 >> limb_bits);
+
+    limb_t c0 = 0;
+    limb_t c1 = 0;
+    limb_t c2 = 0;
+    for (size_t i = 0; i != rn; ++i)
+    {
+        limb_t v1 = x1[i];
+        limb_t v2 = f2.mul(f2.sub(x2[i], v1 % p2), p1_inv_mod_p2);
+        limb_t t = f3.sub(x3[i], v1 % f3.p);
+        t = f3.sub(t, f3.mul(v2 % f3.p, p1_mod_p3));
+        limb_t v3 = f3.mul(t, p1p2_inv_mod_p3);
+
+        // x = v1 + v2 p1 + v3 p1 p2, three limbs
+        dlimb_t s = dlimb_t(v2) * p1 + v1;
+        limb_t y0 = static_cast<limb_t>(s);
+        limb_t y1 = static_cast<limb_t>(s >> limb_bits);
+        s = dlimb_t(v3) * p1p2_lo + y0;
+        y0 = static_cast<limb_t>(s);
+        s = dlimb_t(v3) * p1p2_hi + y1 + static_cast<limb_t>(s >> limb_bits);
+        y1 = static_cast<limb_t>(s);
+        limb_t y2 = static_cast<limb_t>(s >> limb_bits);
+
+        s = dlimb_t(y0) + c0;
+        r[i] = static_cast<limb_t>(s);
+        s = dlimb_t(y1) + c1 + static_cast<limb_t>(s >> limb_bits);
+        c0 = static_cast<limb_t>(s);
+        s = dlimb_t(y2) + c2 + static_cast<limb_t>(s >> limb_bits);
+        c1 = static_cast<limb_t>(s);
+        c2 = static_cast<limb_t>(s >> limb_bits);
+    }
+    assert(c0 == 0 && c1 == 0 && c2 == 0);
+}
+
+void mul_ntt_impl(limb_t* r, limb_t const* a, size_t an, limb_t const* b, size_t bn)
+{
+    size_t rn = an + bn;
+    size_t n = 1;
+    while (n < rn)
+        n *= 2;
+    assert(n <= (size_t(1) << prime(1).max_log));
+
+    std::vector<limb_t> buffer(5 * n);
+    limb_t* residues = buffer.data();
+    limb_t* work = residues + 3 * n;
+    limb_t* roots = work + n;
+    for (size_t i = 0; i != 3; ++i)
+        convolve(residues + i * n, work, roots, n, prime(i), a, an, b, bn);
+    recombine(r, rn, residues, residues + n, residues + 2 * n);
+}
+}
+
+void mul_ntt(limb_t* r, limb_t const* a, size_t an, limb_t const* b, size_t bn)
+{
+    mul_ntt_impl(r, a, an, b, bn);
+}
+
+void sqr_ntt(limb_t* r, limb_t const* a, size_t n)
+{
+    mul_ntt_impl(r, a, n, nullptr, n);
+}
+}
@@ -0,0 +1,264 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "big_integer.h"
+#include "big_integer_gmp.h"
+#include "limbs.h"
+
+// Usage: big_integer_benchmark [limbs...]
+// Times every operator on random operands of the given sizes (64-bit limbs)
+// for big_integer and big_integer_gmp and prints them side by side.
+//
+// Usage: big_integer_benchmark mul [max_limbs]
+// Times a product with each multiplication tier forced at the top level,
+// showing the crossovers that limbs::karatsuba_threshold, limbs::toom3_threshold and
+// limbs::ntt_threshold encode.
+//
+// Usage: big_integer_benchmark sqr [max_limbs]
+// The same for a square, for limbs::sqr_karatsuba_threshold and limbs::sqr_toom3_threshold;
+// the mul column is the general product of two equal operands stored apart.
+//
+// Usage: big_integer_benchmark div [max_limbs]
+// The same for dividing 2n limbs by n limbs with algorithm D against Burnikel-Ziegler
+// recursion and against a Newton reciprocal, for limbs::bz_threshold and limbs::newton_threshold.
+//
+// Usage: big_integer_benchmark gcd [max_limbs]
+// The same for the gcd of two n-limb operands with Lehmer steps against half-gcd, for
+// limbs::gcd_threshold; half-gcd is also timed with its recursion stopping at half and at
+// twice limbs::hgcd_threshold.
+
+namespace {
+double const min_seconds = 0.2;
+
+char const* const op_names[] = {"add", "sub", "mul", "div", "mod", "and", "shl", "to_string", "from_string"};
+
+template<typename F>
+double measure(F&& f, double min_seconds = min_seconds) {
+  typedef std::chrono::steady_clock clock;
+  size_t iterations = 0;
+  clock::time_point start = clock::now();
+  double elapsed;
+  do {
+    f();
+    ++iterations;
+    elapsed = std::chrono::duration<double>(clock::now() - start).count();
+  } while (elapsed < min_seconds);
+  return elapsed * 1e9 / iterations;
+}
+
+// a and b have `limbs` limbs, wide has twice as many so that division does real work
+template<typename T>
+std::vector<double> run_all(std::string const& a_str, std::string const& b_str, std::string const& wide_str) {
+  T a(a_str), b(b_str), wide(wide_str);
+  T r;
+  std::string s;
+  std::vector<double> times;
+  times.push_back(measure([&] { r = a + b; }));
+  times.push_back(measure([&] { r = a - b; }));
+  times.push_back(measure([&] { r = a * b; }));
+  times.push_back(measure([&] { r = wide / b; }));
+  times.push_back(measure([&] { r = wide % b; }));
+  times.push_back(measure([&] { r = a & b; }));
+  times.push_back(measure([&] { r = a << 1000; }));
+  times.push_back(measure([&] { s = to_string(a); }));
+  times.push_back(measure([&] { r = T(a_str); }));
+  return times;
+}
+
+std::string random_operand(size_t limbs, std::mt19937& rng) {
+  big_integer_gmp x;
+  x.random(limbs * 64 - 1, rng);
+  return to_string(x);
+}
+
+void tune_mul(size_t max_limbs, std::mt19937& rng) {
+  size_t const karatsuba = limbs::karatsuba_threshold;
+  size_t const toom3 = limbs::toom3_threshold;
+  size_t const ntt = limbs::ntt_threshold;
+  size_t const never = std::numeric_limits<size_t>::max();
+  double const seconds = 0.05;
+
+  std::printf("%8s %12s %12s %12s %12s %12s %12s\n",
+              "limbs", "schoolbook", "karatsuba", "toom3", "ntt", "default", "gmp");
+  for (size_t n = 8; n <= max_limbs; n += n / 4) {
+    std::string a_str = random_operand(n, rng);
+    std::string b_str = random_operand(n, rng);
+    big_integer a(a_str), b(b_str), r;
+    big_integer_gmp ga(a_str), gb(b_str), gr;
+
+    limbs::karatsuba_threshold = never;
+    limbs::toom3_threshold = never;
+    limbs::ntt_threshold = never;
+    double schoolbook_time = measure([&] { r = a * b; }, seconds);
+
+    limbs::karatsuba_threshold = std::min(n, karatsuba);
+    double karatsuba_time = measure([&] { r = a * b; }, seconds);
+
+    limbs::karatsuba_threshold = karatsuba;
+    limbs::toom3_threshold = n;
+    double toom3_time = measure([&] { r = a * b; }, seconds);
+
+    limbs::toom3_threshold = toom3;
+    limbs::ntt_threshold = n;
+    double ntt_time = measure([&] { r = a * b; }, seconds);
+
+    limbs::ntt_threshold = ntt;
+    double default_time = measure([&] { r = a * b; }, seconds);
+    double gmp_time = measure([&] { gr = ga * gb; }, seconds);
+
+    std::printf("%8zu %12.0f %12.0f %12.0f %12.0f %12.0f %12.0f\n",
+                n, schoolbook_time, karatsuba_time, toom3_time, ntt_time, default_time, gmp_time);
+    std::fflush(stdout);
+  }
+}
+
+void tune_sqr(size_t max_limbs, std::mt19937& rng) {
+  size_t const karatsuba = limbs::sqr_karatsuba_threshold;
+  size_t const toom3 = limbs::sqr_toom3_threshold;
+  size_t const never = std::numeric_limits<size_t>::max();
+  double const seconds = 0.05;
+
+  std::printf("%8s %12s %12s %12s %12s %12s %12s\n",
+              "limbs", "schoolbook", "karatsuba", "toom3", "default", "mul", "gmp");
+  for (size_t n = 8; n <= max_limbs; n += n / 4) {
+    big_integer_gmp ga(random_operand(n, rng)), gr;
+    std::vector<limbs::limb_t> x(n), y(n), r(2 * n);
+    for (size_t i = 0; i != n; ++i)
+      x[i] = y[i] = static_cast<limbs::limb_t>(rng()) << 32 | rng();
+    auto square = [&] { limbs::sqr(r.data(), x.data(), n); };
+
+    limbs::sqr_karatsuba_threshold = never;
+    limbs::sqr_toom3_threshold = never;
+    double schoolbook_time = measure(square, seconds);
+
+    limbs::sqr_karatsuba_threshold = std::min(n, karatsuba);
+    double karatsuba_time = measure(square, seconds);
+
+    limbs::sqr_karatsuba_threshold = karatsuba;
+    limbs::sqr_toom3_threshold = n;
+    double toom3_time = measure(square, seconds);
+
+    limbs::sqr_toom3_threshold = toom3;
+    double default_time = measure(square, seconds);
+    double mul_time = measure([&] { limbs::mul(r.data(), x.data(), n, y.data(), n); }, seconds);
+    double gmp_time = measure([&] { gr = ga * ga; }, seconds);
+
+    std::printf("%8zu %12.0f %12.0f %12.0f %12.0f %12.0f %12.0f\n",
+                n, schoolbook_time, karatsuba_time, toom3_time, default_time, mul_time, gmp_time);
+    std::fflush(stdout);
+  }
+}
+
+void tune_div(size_t max_limbs, std::mt19937& rng) {
+  size_t const bz = limbs::bz_threshold;
+  size_t const newton = limbs::newton_threshold;
+  size_t const never = std::numeric_limits<size_t>::max();
+  double const seconds = 0.05;
+
+  std::printf("%8s %12s %12s %12s %12s %12s\n", "limbs", "knuth", "bz", "newton", "default", "gmp");
+  for (size_t n = 8; n <= max_limbs; n += n / 4) {
+    std::string a_str = random_operand(2 * n, rng);
+    std::string b_str = random_operand(n, rng);
+    big_integer a(a_str), b(b_str), r;
+    big_integer_gmp ga(a_str), gb(b_str), gr;
+
+    limbs::bz_threshold = never;
+    double knuth_time = measure([&] { r = a / b; }, seconds);
+
+    limbs::bz_threshold = std::min(n / 2, bz);
+    double bz_time = measure([&] { r = a / b; }, seconds);
+
+    limbs::bz_threshold = bz;
+    limbs::newton_threshold = std::min(n / 2, newton);
+    double newton_time = measure([&] { r = a / b; }, seconds);
+
+    limbs::newton_threshold = newton;
+    double default_time = measure([&] { r = a / b; }, seconds);
+    double gmp_time = measure([&] { gr = ga / gb; }, seconds);
+
+    std::printf("%8zu %12.0f %12.0f %12.0f %12.0f %12.0f\n",
+                n, knuth_time, bz_time, newton_time, default_time, gmp_time);
+    std::fflush(stdout);
+  }
+}
+
+void tune_gcd(size_t max_limbs, std::mt19937& rng) {
+  size_t const gcd = limbs::gcd_threshold;
+  size_t const hgcd = limbs::hgcd_threshold;
+  size_t const never = std::numeric_limits<size_t>::max();
+  double const seconds = 0.05;
+
+  std::printf("%8s %12s %12s %12s %12s %12s %12s\n",
+              "limbs", "lehmer", "hgcd", "hgcd/2", "hgcd*2", "default", "gmp");
+  for (size_t n = 8; n <= max_limbs; n += n / 4) {
+    std::string a_str = random_operand(n, rng);
+    std::string b_str = random_operand(n, rng);
+    big_integer a(a_str), b(b_str), r;
+    big_integer_gmp ga(a_str), gb(b_str), gr;
+
+    limbs::gcd_threshold = never;
+    double lehmer_time = measure([&] { r = ::gcd(a, b); }, seconds);
+
+    limbs::gcd_threshold = 0;
+    double hgcd_time = measure([&] { r = ::gcd(a, b); }, seconds);
+    limbs::hgcd_threshold = std::max<size_t>(hgcd / 2, 4);
+    double half_time = measure([&] { r = ::gcd(a, b); }, seconds);
+    limbs::hgcd_threshold = 2 * hgcd;
+    double double_time = measure([&] { r = ::gcd(a, b); }, seconds);
+
+    limbs::hgcd_threshold = hgcd;
+    limbs::gcd_threshold = gcd;
+    double default_time = measure([&] { r = ::gcd(a, b); }, seconds);
+    double gmp_time = measure([&] { gr = ::gcd(ga, gb); }, seconds);
+
+    std::printf("%8zu %12.0f %12.0f %12.0f %12.0f %12.0f %12.0f\n",
+                n, lehmer_time, hgcd_time, half_time, double_time, default_time, gmp_time);
+    std::fflush(stdout);
+  }
+}
+}
+
+int main(int argc, char** argv) {
+  std::mt19937 rng(42);
+  if (argc > 1 && std::strcmp(argv[1], "mul") == 0) {
+    tune_mul(argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 2048, rng);
+    return 0;
+  }
+  if (argc > 1 && std::strcmp(argv[1], "sqr") == 0) {
+    tune_sqr(argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 2048, rng);
+    return 0;
+  }
+  if (argc > 1 && std::strcmp(argv[1], "div") == 0) {
+    tune_div(argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 2048, rng);
+    return 0;
+  }
+  if (argc > 1 && std::strcmp(argv[1], "gcd") == 0) {
+    tune_gcd(argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 8192, rng);
+    return 0;
+  }
+
+  std::vector<size_t> sizes;
+  for (int i = 1; i < argc; ++i)
+    sizes.push_back(std::strtoul(argv[i], nullptr, 10));
+  if (sizes.empty())
+    sizes = {1, 4, 64, 1024, 65536};
+
+  std::printf("%-12s %8s %16s %16s %8s\n", "op", "limbs", "big_integer,ns", "gmp,ns", "ratio");
+  for (size_t limbs : sizes) {
+    std::string a = random_operand(limbs, rng);
+    std::string b = random_operand(limbs, rng);
+    std::string wide = random_operand(2 * limbs, rng);
+
+    std::vector<double> ours = run_all<big_integer>(a, b, wide);
+    std::vector<double> gmp = run_all<big_integer_gmp>(a, b, wide);
+    for (size_t i = 0; i != ours.size(); ++i)
+      std::printf("%-12s %8zu %16.0f %16.0f %8.2f\n", op_names[i], limbs, ours[i], gmp[i], ours[i] / gmp[i]);
+    std::fflush(stdout);
+  }
+}
@@ -2,6 +2,7 @@
 
 #include <cstring>
 #include <stdexcept>
+#include <utility>
 
 big_integer_gmp::big_integer_gmp() {
   mpz_init(mpz);
@@ -11,6 +12,12 @@ big_integer_gmp::big_integer_gmp(big_integer_gmp const& other) {
   mpz_init_set(mpz, other.mpz);
 }
 
+// mpz_init does not allocate (since GMP 6.2), so stealing the limbs is free
+big_integer_gmp::big_integer_gmp(big_integer_gmp&& other) noexcept {
+  mpz_init(mpz);
+  mpz_swap(mpz, other.mpz);
+}
+
 big_integer_gmp::big_integer_gmp(int a) {
   mpz_init_set_si(mpz, a);
 }
@@ -31,6 +38,20 @@ big_integer_gmp& big_integer_gmp::operator=(big_integer_gmp const& other) {
   return *this;
 }
 
+big_integer_gmp& big_integer_gmp::operator=(big_integer_gmp&& other) noexcept {
+  mpz_swap(mpz, other.mpz);
+  mpz_set_ui(other.mpz, 0);
+  return *this;
+}
+
+void big_integer_gmp::swap(big_integer_gmp& other) noexcept {
+  mpz_swap(mpz, other.mpz);
+}
+
+void swap(big_integer_gmp& a, big_integer_gmp& b) noexcept {
+  a.swap(b);
+}
+
 big_integer_gmp& big_integer_gmp::operator+=(big_integer_gmp const& rhs) {
   mpz_add(mpz, mpz, rhs.mpz);
   return *this;
@@ -85,12 +106,17 @@ big_integer_gmp big_integer_gmp::operator+() const {
   return *this;
 }
 
-big_integer_gmp big_integer_gmp::operator-() const {
+big_integer_gmp big_integer_gmp::operator-() const& {
   big_integer_gmp r;
   mpz_neg(r.mpz, mpz);
   return r;
 }
 
+big_integer_gmp big_integer_gmp::operator-() && {
+  mpz_neg(mpz, mpz);
+  return std::move(*this);
+}
+
 big_integer_gmp big_integer_gmp::operator~() const {
   big_integer_gmp r;
   mpz_com(r.mpz, mpz);
@@ -120,43 +146,83 @@ big_integer_gmp big_integer_gmp::operator--(int) {
 }
 
 big_integer_gmp operator+(big_integer_gmp a, big_integer_gmp const& b) {
-  return a += b;
+  a += b;
+  return a;
+}
+
+big_integer_gmp operator+(big_integer_gmp const& a, big_integer_gmp&& b) {
+  b += a;
+  return std::move(b);
 }
 
 big_integer_gmp operator-(big_integer_gmp a, big_integer_gmp const& b) {
-  return a -= b;
+  a -= b;
+  return a;
+}
+
+big_integer_gmp operator-(big_integer_gmp const& a, big_integer_gmp&& b) {
+  b -= a;
+  return -std::move(b);
 }
 
 big_integer_gmp operator*(big_integer_gmp a, big_integer_gmp const& b) {
-  return a *= b;
+  a *= b;
+  return a;
+}
+
+big_integer_gmp operator*(big_integer_gmp const& a, big_integer_gmp&& b) {
+  b *= a;
+  return std::move(b);
 }
 
 big_integer_gmp operator/(big_integer_gmp a, big_integer_gmp const& b) {
-  return a /= b;
+  a /= b;
+  return a;
 }
 
 big_integer_gmp operator%(big_integer_gmp a, big_integer_gmp const& b) {
-  return a %= b;
+  a %= b;
+  return a;
 }
 
 big_integer_gmp operator&(big_integer_gmp a, big_integer_gmp const& b) {
-  return a &= b;
+  a &= b;
+  return a;
+}
+
+big_integer_gmp operator&(big_integer_gmp const& a, big_integer_gmp&& b) {
+  b &= a;
+  return std::move(b);
 }
 
 big_integer_gmp operator|(big_integer_gmp a, big_integer_gmp const& b) {
-  return a |= b;
+  a |= b;
+  return a;
+}
+
+big_integer_gmp operator|(big_integer_gmp const& a, big_integer_gmp&& b) {
+  b |= a;
+  return std::move(b);
 }
 
 big_integer_gmp operator^(big_integer_gmp a, big_integer_gmp const& b) {
-  return a ^= b;
+  a ^= b;
+  return a;
+}
+
+big_integer_gmp operator^(big_integer_gmp const& a, big_integer_gmp&& b) {
+  b ^= a;
+  return std::move(b);
 }
 
 big_integer_gmp operator<<(big_integer_gmp a, int b) {
-  return a <<= b;
+  a <<= b;
+  return a;
 }
 
 big_integer_gmp operator>>(big_integer_gmp a, int b) {
-  return a >>= b;
+  a >>= b;
+  return a;
 }
 
 bool operator==(big_integer_gmp const& a, big_integer_gmp const& b) {
@@ -183,6 +249,24 @@ bool operator>=(big_integer_gmp const& a, big_integer_gmp const& b) {
   return mpz_cmp(a.mpz, b.mpz) >= 0;
 }
 
+big_integer_gmp powmod(big_integer_gmp const& base, big_integer_gmp const& exp, big_integer_gmp const& mod) {
+  big_integer_gmp r;
+  mpz_powm(r.mpz, base.mpz, exp.mpz, mod.mpz);
+  return r;
+}
+
+big_integer_gmp gcd(big_integer_gmp const& a, big_integer_gmp const& b) {
+  big_integer_gmp r;
+  mpz_gcd(r.mpz, a.mpz, b.mpz);
+  return r;
+}
+
+big_integer_gmp iroot(big_integer_gmp const& a, unsigned long k) {
+  big_integer_gmp r;
+  mpz_root(r.mpz, a.mpz, k);
+  return r;
+}
+
 std::string to_string(big_integer_gmp const& a) {
   char* tmp = mpz_get_str(NULL, 10, a.mpz);
   std::string res = tmp;
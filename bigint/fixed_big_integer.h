@@ -0,0 +1,603 @@
+#ifndef FIXED_BIG_INTEGER_H
+#define FIXED_BIG_INTEGER_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <stdexcept>
+#include <string>
+
+#include "big_integer.h"
+
+// what fixed_big_integer does with a result outside its range
+enum class fixed_overflow
+{
+    // keep it modulo 2^Bits, as built-in unsigned arithmetic does
+    wrap,
+    // throw std::runtime_error
+    check
+};
+
+// The sign and limbs of a big_integer, through which fixed_big_integer converts limb by limb.
+struct big_integer_fixed_conversion
+{
+    static bool negative(big_integer const& a)
+    {
+        return a.negative;
+    }
+
+    static big_integer::limb_t const* data(big_integer const& a)
+    {
+        return a.mag.data();
+    }
+
+    static size_t size(big_integer const& a)
+    {
+        return a.mag.size();
+    }
+
+    // a shift count of any built-in type, taken as big_integer takes it
+    template <typename T>
+    static constexpr uint64_t shift_count(T a)
+    {
+        return big_integer::shift_count(a);
+    }
+
+    // the magnitude may have leading zero limbs
+    static big_integer make(bool negative, big_integer::limb_t const* data, size_t size)
+    {
+        big_integer r;
+        r.mag.assign(data, data + size);
+        r.negative = negative;
+        r.normalize();
+        return r;
+    }
+};
+
+// An integer of Bits bits, a multiple of 64, in two's complement: signed values lie in
+// [-2^(Bits-1), 2^(Bits-1)), unsigned ones in [0, 2^Bits). The limbs are a std::array inside
+// the object, so a value never allocates, copies as plain memory and works in constant
+// expressions. Every loop but division's runs over all the limbs and is unrolled up to 16 of
+// them (1024 bits): a sum is one carry chain, a product Bits^2 / 4096 multiplications, and
+// neither checks a size. A result out of range wraps or throws as Overflow says. Division
+// truncates toward zero and a right shift of a negative value rounds toward -inf, as for
+// big_integer; conversions to and from big_integer copy the limbs.
+template <size_t Bits, bool Signed = true, fixed_overflow Overflow = fixed_overflow::wrap>
+struct fixed_big_integer
+{
+    static_assert(Bits != 0 && Bits % 64 == 0, "fixed_big_integer holds whole limbs");
+
+    typedef big_integer::limb_t limb_t;
+    typedef big_integer::uint128_t uint128_t;
+
+    static constexpr size_t limb_count = Bits / 64;
+
+    constexpr fixed_big_integer()
+        : digits{}
+    {}
+
+    template <typename T, big_integer::if_machine_integer<T> = 0>
+    constexpr fixed_big_integer(T a)
+        : digits{}
+    {
+        // sign-extended to 128 bits, then to the limbs
+        bool sign = a < 0;
+        uint128_t m = static_cast<uint128_t>(a);
+        limb_t high = static_cast<limb_t>(m >> 64);
+        limb_t extension = sign ? ~limb_t(0) : 0;
+        for (size_t i = 0; i != limb_count; ++i)
+            digits[i] = i == 0 ? static_cast<limb_t>(m) : i == 1 ? high : extension;
+        check((Signed || !sign) && (limb_count > 1 || high == extension)
+              && (!Signed || limb_count > 2 || negative() == sign));
+    }
+
+    // wraps a out of range modulo 2^Bits
+    explicit fixed_big_integer(big_integer const& a)
+        : digits{}
+    {
+        size_t n = big_integer_fixed_conversion::size(a);
+        limb_t const* p = big_integer_fixed_conversion::data(a);
+        for (size_t i = 0; i != limb_count && i != n; ++i)
+            digits[i] = p[i];
+        bool sign = big_integer_fixed_conversion::negative(a);
+        if (sign)
+            negate(digits);
+        check(n <= limb_count && (Signed ? negative() == sign : !sign));
+    }
+
+    explicit operator big_integer() const
+    {
+        digits_t m = magnitude();
+        return big_integer_fixed_conversion::make(negative(), m.data(), limb_count);
+    }
+
+    constexpr fixed_big_integer& operator+=(fixed_big_integer const& rhs)
+    {
+        bool sign = negative();
+        bool rhs_sign = rhs.negative();
+        limb_t carry = 0;
+#pragma GCC unroll 16
+        for (size_t i = 0; i != limb_count; ++i)
+        {
+            uint128_t t = uint128_t(digits[i]) + rhs.digits[i] + carry;
+            digits[i] = static_cast<limb_t>(t);
+            carry = static_cast<limb_t>(t >> 64);
+        }
+        check(Signed ? sign != rhs_sign || negative() == sign : carry == 0);
+        return *this;
+    }
+
+    constexpr fixed_big_integer& operator-=(fixed_big_integer const& rhs)
+    {
+        bool sign = negative();
+        bool rhs_sign = rhs.negative();
+        limb_t borrow = 0;
+#pragma GCC unroll 16
+        for (size_t i = 0; i != limb_count; ++i)
+        {
+            uint128_t t = uint128_t(digits[i]) - rhs.digits[i] - borrow;
+            digits[i] = static_cast<limb_t>(t);
+            borrow = static_cast<limb_t>(t >> 64) & 1;
+        }
+        check(Signed ? sign == rhs_sign || negative() == sign : borrow == 0);
+        return *this;
+    }
+
+    constexpr fixed_big_integer& operator*=(fixed_big_integer const& rhs)
+    {
+        if constexpr (Overflow == fixed_overflow::wrap)
+        {
+            // the low limbs of a product do not depend on the signs
+            digits = multiply<limb_count>(digits, rhs.digits);
+        }
+        else
+        {
+            bool sign = negative() != rhs.negative();
+            std::array<limb_t, 2 * limb_count> p = multiply<2 * limb_count>(magnitude(), rhs.magnitude());
+            bool high_zero = true;
+            for (size_t i = 0; i != limb_count; ++i)
+            {
+                digits[i] = p[i];
+                high_zero = high_zero && p[limb_count + i] == 0;
+            }
+            if (sign)
+                negate(digits);
+            // a nonzero signed product must come out with its sign, which rules out
+            // magnitudes from 2^(Bits-1) up except -2^(Bits-1) itself
+            check(high_zero && (!Signed || negative() == sign || is_zero()));
+        }
+        return *this;
+    }
+
+    constexpr fixed_big_integer& operator/=(fixed_big_integer const& rhs)
+    {
+        digits_t q{};
+        digits_t r{};
+        divide(rhs, q, r);
+        *this = quotient(q, negative() != rhs.negative());
+        return *this;
+    }
+
+    constexpr fixed_big_integer& operator%=(fixed_big_integer const& rhs)
+    {
+        digits_t q{};
+        digits_t r{};
+        divide(rhs, q, r);
+        if (negative())
+            negate(r);
+        digits = r;
+        return *this;
+    }
+
+    constexpr fixed_big_integer& operator&=(fixed_big_integer const& rhs)
+    {
+#pragma GCC unroll 16
+        for (size_t i = 0; i != limb_count; ++i)
+            digits[i] &= rhs.digits[i];
+        return *this;
+    }
+
+    constexpr fixed_big_integer& operator|=(fixed_big_integer const& rhs)
+    {
+#pragma GCC unroll 16
+        for (size_t i = 0; i != limb_count; ++i)
+            digits[i] |= rhs.digits[i];
+        return *this;
+    }
+
+    constexpr fixed_big_integer& operator^=(fixed_big_integer const& rhs)
+    {
+#pragma GCC unroll 16
+        for (size_t i = 0; i != limb_count; ++i)
+            digits[i] ^= rhs.digits[i];
+        return *this;
+    }
+
+    // shift counts are in bits, a negative count shifts the other way; every built-in integer
+    // is taken at its own width. A left shift overflows when it drops a bit that differs from
+    // the sign
+    template <typename T, big_integer::if_machine_integer<T> = 0>
+    constexpr fixed_big_integer& operator<<=(T rhs)
+    {
+        uint64_t bits = big_integer_fixed_conversion::shift_count(rhs);
+        return rhs < 0 ? shift_right(bits) : shift_left(bits);
+    }
+
+    template <typename T, big_integer::if_machine_integer<T> = 0>
+    constexpr fixed_big_integer& operator>>=(T rhs)
+    {
+        uint64_t bits = big_integer_fixed_conversion::shift_count(rhs);
+        return rhs < 0 ? shift_left(bits) : shift_right(bits);
+    }
+
+    constexpr fixed_big_integer operator+() const
+    {
+        return *this;
+    }
+
+    constexpr fixed_big_integer operator-() const
+    {
+        fixed_big_integer r = *this;
+        negate(r.digits);
+        check(Signed ? is_zero() || r.negative() != negative() : is_zero());
+        return r;
+    }
+
+    constexpr fixed_big_integer operator~() const
+    {
+        fixed_big_integer r;
+#pragma GCC unroll 16
+        for (size_t i = 0; i != limb_count; ++i)
+            r.digits[i] = ~digits[i];
+        return r;
+    }
+
+    constexpr fixed_big_integer& operator++()
+    {
+        return *this += 1;
+    }
+
+    constexpr fixed_big_integer operator++(int)
+    {
+        fixed_big_integer r = *this;
+        ++*this;
+        return r;
+    }
+
+    constexpr fixed_big_integer& operator--()
+    {
+        return *this -= 1;
+    }
+
+    constexpr fixed_big_integer operator--(int)
+    {
+        fixed_big_integer r = *this;
+        --*this;
+        return r;
+    }
+
+    friend constexpr fixed_big_integer operator+(fixed_big_integer a, fixed_big_integer const& b)
+    {
+        a += b;
+        return a;
+    }
+
+    friend constexpr fixed_big_integer operator-(fixed_big_integer a, fixed_big_integer const& b)
+    {
+        a -= b;
+        return a;
+    }
+
+    friend constexpr fixed_big_integer operator*(fixed_big_integer a, fixed_big_integer const& b)
+    {
+        a *= b;
+        return a;
+    }
+
+    friend constexpr fixed_big_integer operator/(fixed_big_integer a, fixed_big_integer const& b)
+    {
+        a /= b;
+        return a;
+    }
+
+    friend constexpr fixed_big_integer operator%(fixed_big_integer a, fixed_big_integer const& b)
+    {
+        a %= b;
+        return a;
+    }
+
+    friend constexpr fixed_big_integer operator&(fixed_big_integer a, fixed_big_integer const& b)
+    {
+        a &= b;
+        return a;
+    }
+
+    friend constexpr fixed_big_integer operator|(fixed_big_integer a, fixed_big_integer const& b)
+    {
+        a |= b;
+        return a;
+    }
+
+    friend constexpr fixed_big_integer operator^(fixed_big_integer a, fixed_big_integer const& b)
+    {
+        a ^= b;
+        return a;
+    }
+
+    template <typename T, big_integer::if_machine_integer<T> = 0>
+    friend constexpr fixed_big_integer operator<<(fixed_big_integer a, T b)
+    {
+        a <<= b;
+        return a;
+    }
+
+    template <typename T, big_integer::if_machine_integer<T> = 0>
+    friend constexpr fixed_big_integer operator>>(fixed_big_integer a, T b)
+    {
+        a >>= b;
+        return a;
+    }
+
+    friend constexpr bool operator==(fixed_big_integer const& a, fixed_big_integer const& b)
+    {
+        return a.compare(b) == 0;
+    }
+
+    friend constexpr bool operator!=(fixed_big_integer const& a, fixed_big_integer const& b)
+    {
+        return a.compare(b) != 0;
+    }
+
+    friend constexpr bool operator<(fixed_big_integer const& a, fixed_big_integer const& b)
+    {
+        return a.compare(b) < 0;
+    }
+
+    friend constexpr bool operator>(fixed_big_integer const& a, fixed_big_integer const& b)
+    {
+        return a.compare(b) > 0;
+    }
+
+    friend constexpr bool operator<=(fixed_big_integer const& a, fixed_big_integer const& b)
+    {
+        return a.compare(b) <= 0;
+    }
+
+    friend constexpr bool operator>=(fixed_big_integer const& a, fixed_big_integer const& b)
+    {
+        return a.compare(b) >= 0;
+    }
+
+    friend std::string to_string(fixed_big_integer const& a)
+    {
+        return to_string(big_integer(a));
+    }
+
+    friend std::ostream& operator<<(std::ostream& s, fixed_big_integer const& a)
+    {
+        return s << big_integer(a);
+    }
+
+private:
+    typedef std::array<limb_t, limb_count> digits_t;
+
+    static constexpr void check(bool in_range)
+    {
+        if (Overflow == fixed_overflow::check && !in_range)
+            throw std::runtime_error("fixed_big_integer overflow");
+    }
+
+    constexpr bool negative() const
+    {
+        return Signed && digits[limb_count - 1] >> 63 != 0;
+    }
+
+    constexpr bool is_zero() const
+    {
+        limb_t any = 0;
+        for (size_t i = 0; i != limb_count; ++i)
+            any |= digits[i];
+        return any == 0;
+    }
+
+    constexpr int compare(fixed_big_integer const& rhs) const
+    {
+        if (negative() != rhs.negative())
+            return negative() ? -1 : 1;
+        // two's complement orders values of one sign as unsigned numbers
+        for (size_t i = limb_count; i-- != 0;)
+        {
+            if (digits[i] != rhs.digits[i])
+                return digits[i] < rhs.digits[i] ? -1 : 1;
+        }
+        return 0;
+    }
+
+    static constexpr void negate(digits_t& a)
+    {
+        limb_t carry = 1;
+#pragma GCC unroll 16
+        for (size_t i = 0; i != limb_count; ++i)
+        {
+            uint128_t t = uint128_t(~a[i]) + carry;
+            a[i] = static_cast<limb_t>(t);
+            carry = static_cast<limb_t>(t >> 64);
+        }
+    }
+
+    // |value| as an unsigned number, 2^(Bits-1) included
+    constexpr digits_t magnitude() const
+    {
+        digits_t r = digits;
+        if (negative())
+            negate(r);
+        return r;
+    }
+
+    // the low N limbs of a * b
+    template <size_t N>
+    static constexpr std::array<limb_t, N> multiply(digits_t const& a, digits_t const& b)
+    {
+        std::array<limb_t, N> r{};
+#pragma GCC unroll 16
+        for (size_t i = 0; i != limb_count; ++i)
+        {
+            limb_t carry = 0;
+#pragma GCC unroll 16
+            for (size_t j = 0; j != limb_count; ++j)
+            {
+                if (i + j < N)
+                {
+                    uint128_t t = uint128_t(a[i]) * b[j] + r[i + j] + carry;
+                    r[i + j] = static_cast<limb_t>(t);
+                    carry = static_cast<limb_t>(t >> 64);
+                }
+            }
+            if (i + limb_count < N)
+                r[i + limb_count] = carry;
+        }
+        return r;
+    }
+
+    // the quotient of magnitudes with the given sign
+    static constexpr fixed_big_integer quotient(digits_t const& q, bool sign)
+    {
+        fixed_big_integer r;
+        r.digits = q;
+        if (sign)
+            negate(r.digits);
+        // only -2^(Bits-1) / -1 leaves the range
+        check(!Signed || sign || !r.negative());
+        return r;
+    }
+
+    // |*this| / |rhs| and |*this| % |rhs| by schoolbook division (Knuth's algorithm D)
+    constexpr void divide(fixed_big_integer const& rhs, digits_t& q, digits_t& r) const
+    {
+        digits_t u = magnitude();
+        digits_t v = rhs.magnitude();
+        size_t m = limb_count;
+        while (m != 0 && u[m - 1] == 0)
+            --m;
+        size_t n = limb_count;
+        while (n != 0 && v[n - 1] == 0)
+            --n;
+        if (n == 0)
+            throw std::runtime_error("division by zero");
+        if (m < n)
+        {
+            r = u;
+            return;
+        }
+        if (n == 1)
+        {
+            limb_t rem = 0;
+            for (size_t i = m; i-- != 0;)
+            {
+                uint128_t t = uint128_t(rem) << 64 | u[i];
+                q[i] = static_cast<limb_t>(t / v[0]);
+                rem = static_cast<limb_t>(t % v[0]);
+            }
+            r[0] = rem;
+            return;
+        }
+
+        // normalized so the top limb of the divisor has its high bit set
+        unsigned s = __builtin_clzll(v[n - 1]);
+        std::array<limb_t, limb_count + 1> un{};
+        digits_t vn{};
+        for (size_t i = 0; i != n; ++i)
+            vn[i] = v[i] << s | (s != 0 && i != 0 ? v[i - 1] >> (64 - s) : 0);
+        for (size_t i = 0; i != m; ++i)
+            un[i] = u[i] << s | (s != 0 && i != 0 ? u[i - 1] >> (64 - s) : 0);
+        un[m] = s != 0 ? u[m - 1] >> (64 - s) : 0;
+
+        for (size_t j = m - n + 1; j-- != 0;)
+        {
+            uint128_t top = uint128_t(un[j + n]) << 64 | un[j + n - 1];
+            uint128_t qhat = top / vn[n - 1];
+            uint128_t rhat = top % vn[n - 1];
+            while (qhat >> 64 != 0 || qhat * vn[n - 2] > (rhat << 64 | un[j + n - 2]))
+            {
+                --qhat;
+                rhat += vn[n - 1];
+                if (rhat >> 64 != 0)
+                    break;
+            }
+
+            limb_t carry = 0;
+            limb_t borrow = 0;
+            for (size_t i = 0; i != n; ++i)
+            {
+                uint128_t p = qhat * vn[i] + carry;
+                carry = static_cast<limb_t>(p >> 64);
+                uint128_t t = uint128_t(un[i + j]) - static_cast<limb_t>(p) - borrow;
+                un[i + j] = static_cast<limb_t>(t);
+                borrow = static_cast<limb_t>(t >> 64) & 1;
+            }
+            uint128_t t = uint128_t(un[j + n]) - carry - borrow;
+            un[j + n] = static_cast<limb_t>(t);
+            if (t >> 64 != 0)
+            {
+                // qhat was one too large
+                --qhat;
+                carry = 0;
+                for (size_t i = 0; i != n; ++i)
+                {
+                    uint128_t a = uint128_t(un[i + j]) + vn[i] + carry;
+                    un[i + j] = static_cast<limb_t>(a);
+                    carry = static_cast<limb_t>(a >> 64);
+                }
+                un[j + n] += carry;
+            }
+            q[j] = static_cast<limb_t>(qhat);
+        }
+        for (size_t i = 0; i != n; ++i)
+            r[i] = un[i] >> s | (s != 0 ? un[i + 1] << (64 - s) : 0);
+    }
+
+    constexpr fixed_big_integer& shift_left(uint64_t bits)
+    {
+        fixed_big_integer old = *this;
+        digits_t r{};
+        if (bits < Bits)
+        {
+            size_t limbs = bits / 64;
+            unsigned s = bits % 64;
+#pragma GCC unroll 16
+            for (size_t i = limbs; i != limb_count; ++i)
+                r[i] = digits[i - limbs] << s | (s != 0 && i != limbs ? digits[i - limbs - 1] >> (64 - s) : 0);
+        }
+        digits = r;
+        if constexpr (Overflow == fixed_overflow::check)
+        {
+            // the dropped bits come back if and only if they all equalled the sign
+            fixed_big_integer back = *this;
+            back.shift_right(bits);
+            check(back == old);
+        }
+        return *this;
+    }
+
+    constexpr fixed_big_integer& shift_right(uint64_t bits)
+    {
+        limb_t fill = negative() ? ~limb_t(0) : 0;
+        digits_t r{};
+        size_t limbs = bits < Bits ? bits / 64 : limb_count;
+        unsigned s = bits < Bits ? bits % 64 : 0;
+#pragma GCC unroll 16
+        for (size_t i = 0; i != limb_count; ++i)
+        {
+            limb_t low = i + limbs < limb_count ? digits[i + limbs] : fill;
+            limb_t high = i + limbs + 1 < limb_count ? digits[i + limbs + 1] : fill;
+            r[i] = s != 0 ? low >> s | high << (64 - s) : low;
+        }
+        digits = r;
+        return *this;
+    }
+
+    digits_t digits;
+};
+
+#endif // FIXED_BIG_INTEGER_H
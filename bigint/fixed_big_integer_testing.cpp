@@ -0,0 +1,181 @@
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <gtest/gtest.h>
+
+#include "big_integer.h"
+#include "fixed_big_integer.h"
+
+typedef fixed_big_integer<256> int256;
+typedef fixed_big_integer<256, false> uint256;
+typedef fixed_big_integer<128, true, fixed_overflow::check> checked_int128;
+typedef fixed_big_integer<128, false, fixed_overflow::check> checked_uint128;
+
+namespace {
+constexpr uint256 constexpr_factorial(unsigned n) {
+  uint256 r = 1;
+  for (unsigned i = 2; i <= n; ++i)
+    r *= i;
+  return r;
+}
+
+// x taken into the range of a fixed_big_integer of the given width modulo 2^bits
+big_integer wrap(big_integer x, size_t bits, bool is_signed) {
+  big_integer m = big_integer(1) << bits;
+  x &= m - 1;
+  if (is_signed && x >= m / 2)
+    x -= m;
+  return x;
+}
+
+big_integer random_value(size_t limbs, std::mt19937_64& rng) {
+  big_integer r;
+  size_t n = rng() % (limbs + 1);
+  for (size_t i = 0; i != n; ++i) {
+    r <<= 64;
+    // runs of zero and all-one limbs reach the carry and borrow edges
+    uint64_t x = rng();
+    r += x % 4 == 0 ? 0 : x % 4 == 1 ? UINT64_MAX : x;
+  }
+  return rng() % 2 ? -r : r;
+}
+
+template <typename F>
+void compare_with_big_integer(size_t bits, bool is_signed) {
+  std::mt19937_64 rng(42);
+  for (size_t itn = 0; itn != 2000; ++itn) {
+    big_integer a = wrap(random_value(bits / 64 + 1, rng), bits, is_signed);
+    big_integer b = wrap(random_value(bits / 64 + 1, rng), bits, is_signed);
+    F x(a), y(b);
+    EXPECT_EQ(a, big_integer(x));
+    EXPECT_EQ(wrap(a + b, bits, is_signed), big_integer(x + y));
+    EXPECT_EQ(wrap(a - b, bits, is_signed), big_integer(x - y));
+    EXPECT_EQ(wrap(a * b, bits, is_signed), big_integer(x * y));
+    EXPECT_EQ(wrap(-a, bits, is_signed), big_integer(-x));
+    EXPECT_EQ(wrap(a & b, bits, is_signed), big_integer(x & y));
+    EXPECT_EQ(wrap(a | b, bits, is_signed), big_integer(x | y));
+    EXPECT_EQ(wrap(a ^ b, bits, is_signed), big_integer(x ^ y));
+    EXPECT_EQ(wrap(~a, bits, is_signed), big_integer(~x));
+    if (b != 0) {
+      EXPECT_EQ(wrap(a / b, bits, is_signed), big_integer(x / y));
+      EXPECT_EQ(a % b, big_integer(x % y));
+    }
+    int64_t s = static_cast<int64_t>(rng() % (bits + 10));
+    EXPECT_EQ(wrap(a << s, bits, is_signed), big_integer(x << s));
+    EXPECT_EQ(a >> s, big_integer(x >> s));
+    EXPECT_EQ(a >> s, big_integer(x << -s));
+    EXPECT_EQ(a < b, x < y);
+    EXPECT_EQ(a <= b, x <= y);
+    EXPECT_EQ(a == b, x == y);
+    EXPECT_EQ(a != b, x != y);
+  }
+}
+} // namespace
+
+TEST(fixed_big_integer, constexpr_arithmetic) {
+  static_assert(std::is_trivially_copyable<int256>::value, "");
+  static_assert(sizeof(int256) == 32, "");
+
+  constexpr uint256 f = constexpr_factorial(50);
+  constexpr uint256 g = f / constexpr_factorial(48);
+  static_assert(g == 50 * 49, "");
+  static_assert(f % 1000000007 == 318608048, "");
+  static_assert((uint256(1) << 255 >> 255) == 1, "");
+  static_assert((int256(-1) << 255 >> 254) == -2, "");
+  static_assert(int256(-7) / 2 == -3 && int256(-7) % 2 == -1, "");
+  static_assert(int256(-7) >> 1 == -4, "");
+  static_assert(int256(-1) < int256(0) && uint256(-1) > uint256(0), "");
+  static_assert(uint256(0) - 1 == ~uint256(0), "");
+  static_assert(checked_int128(INT64_MIN) * INT64_MIN == checked_int128(1) << 126, "");
+  EXPECT_EQ("30414093201713378043612608166064768844377641568960512000000000000", to_string(f));
+}
+
+TEST(fixed_big_integer, wraps_around) {
+  uint256 max = ~uint256(0);
+  EXPECT_EQ(0, big_integer(max + 1));
+  EXPECT_EQ(1, big_integer(max * max));
+  EXPECT_EQ(0, big_integer(uint256(1) << 256));
+
+  int256 min = int256(1) << 255;
+  EXPECT_EQ(-(big_integer(1) << 255), big_integer(min));
+  EXPECT_EQ(min, -min);
+  EXPECT_EQ(min, min / -1);
+  EXPECT_EQ(min - 1, ~min);
+  EXPECT_EQ(int256(big_integer(1) << 255), min);
+  EXPECT_EQ(int256(big_integer("-115792089237316195423570985008687907853269984665640564039457584007913129639937")), -1);
+}
+
+TEST(fixed_big_integer, checked_overflow) {
+  checked_int128 max = (checked_int128(1) << 126) - 1 + (checked_int128(1) << 126);
+  checked_int128 min = -max - 1;
+  EXPECT_EQ((big_integer(1) << 127) - 1, big_integer(max));
+  EXPECT_THROW(max + 1, std::runtime_error);
+  EXPECT_THROW(min - 1, std::runtime_error);
+  EXPECT_THROW(-min, std::runtime_error);
+  EXPECT_THROW(min / -1, std::runtime_error);
+  EXPECT_THROW(max * 2, std::runtime_error);
+  EXPECT_THROW(min * -1, std::runtime_error);
+  EXPECT_THROW(checked_int128(3) << 126, std::runtime_error);
+  EXPECT_THROW(checked_int128(1) << 1000, std::runtime_error);
+  EXPECT_THROW(checked_int128(big_integer(1) << 127), std::runtime_error);
+  EXPECT_THROW(checked_int128(~big_integer::uint128_t(0)), std::runtime_error);
+  EXPECT_THROW(checked_int128(1) / 0, std::runtime_error);
+  EXPECT_EQ(min, min * 1);
+  EXPECT_EQ(min, (max / -2 - 1) * 2);
+  EXPECT_EQ(min, checked_int128(-1) << 127);
+  EXPECT_EQ(0, checked_int128(0) << 1000);
+  EXPECT_EQ(0, min + max + 1);
+
+  checked_uint128 umax = ~checked_uint128(0);
+  EXPECT_THROW(umax + 1, std::runtime_error);
+  EXPECT_THROW(checked_uint128(0) - 1, std::runtime_error);
+  EXPECT_THROW(-checked_uint128(1), std::runtime_error);
+  EXPECT_THROW(umax * 2, std::runtime_error);
+  EXPECT_THROW(checked_uint128(-1), std::runtime_error);
+  EXPECT_THROW(checked_uint128(big_integer(-1)), std::runtime_error);
+  EXPECT_EQ(umax, checked_uint128(~big_integer::uint128_t(0)));
+  EXPECT_EQ(0, -checked_uint128(0));
+  EXPECT_EQ(umax / 3 * 3, umax);
+
+  typedef fixed_big_integer<64, true, fixed_overflow::check> checked_int64;
+  EXPECT_EQ(INT64_MIN, big_integer(checked_int64(INT64_MIN)));
+  EXPECT_THROW(checked_int64(uint64_t(1) << 63), std::runtime_error);
+  EXPECT_THROW(checked_int64(big_integer::int128_t(1) << 64), std::runtime_error);
+}
+
+TEST(fixed_big_integer, wide_shift_counts) {
+  // unsigned counts past INT64_MAX must not wrap to a negative count and shift the other way
+  int256 a = -5;
+  EXPECT_EQ(-1, a >> (uint64_t(1) << 63));
+  EXPECT_EQ(-1, a >> SIZE_MAX);
+  EXPECT_EQ(0, -a >> ~big_integer::uint128_t(0));
+  EXPECT_EQ(0, a << (uint64_t(1) << 63));
+  EXPECT_EQ(0, a << SIZE_MAX);
+  EXPECT_EQ(-1, a << -(big_integer::int128_t(1) << 100));
+  a <<= size_t(1) << 63;
+  EXPECT_EQ(0, a);
+  static_assert((uint256(1) << (uint64_t(1) << 63)) == 0, "");
+  EXPECT_THROW(checked_int128(1) << SIZE_MAX, std::runtime_error);
+  EXPECT_EQ(0, checked_int128(0) << SIZE_MAX);
+  EXPECT_EQ(-1, checked_int128(-3) >> (uint64_t(1) << 63));
+}
+
+TEST(fixed_big_integer, increments_and_strings) {
+  int256 a = -2;
+  EXPECT_EQ(-2, big_integer(a++));
+  EXPECT_EQ(0, big_integer(++a));
+  EXPECT_EQ(0, big_integer(a--));
+  EXPECT_EQ(-2, big_integer(--a));
+  EXPECT_EQ("-2", to_string(a));
+  EXPECT_EQ("340282366920938463463374607431768211455", to_string(~fixed_big_integer<128, false>(0)));
+}
+
+TEST(fixed_big_integer, random_against_big_integer) {
+  compare_with_big_integer<int256>(256, true);
+  compare_with_big_integer<uint256>(256, false);
+  compare_with_big_integer<fixed_big_integer<192>>(192, true);
+  compare_with_big_integer<fixed_big_integer<64, false>>(64, false);
+  compare_with_big_integer<fixed_big_integer<512>>(512, true);
+}
@@ -0,0 +1,711 @@
+#include "limbs.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <vector>
+
+namespace limbs
+{
+size_t normalized_size(limb_t const* a, size_t n)
+{
+    while (n != 0 && a[n - 1] == 0)
+        --n;
+    return n;
+}
+
+int cmp(limb_t const* a, limb_t const* b, size_t n)
+{
+    while (n-- != 0)
+    {
+        if (a[n] != b[n])
+            return a[n] < b[n] ? -1 : 1;
+    }
+    return 0;
+}
+
+int cmp(limb_t const* a, size_t an, limb_t const* b, size_t bn)
+{
+    an = normalized_size(a, an);
+    bn = normalized_size(b, bn);
+    if (an != bn)
+        return an < bn ? -1 : 1;
+    return cmp(a, b, an);
+}
+
+limb_t add_n(limb_t* r, limb_t const* a, limb_t const* b, size_t n)
+{
+    limb_t carry = 0;
+    for (size_t i = 0; i != n; ++i)
+    {
+        limb_t s = a[i] + carry;
+        carry = s < carry;
+        limb_t t = s + b[i];
+        carry += t < s;
+        r[i] = t;
+    }
+    return carry;
+}
+
+limb_t add(limb_t* r, limb_t const* a, size_t an, limb_t const* b, size_t bn)
+{
+    assert(an >= bn);
+    limb_t carry = add_n(r, a, b, bn);
+    return add_1(r + bn, a + bn, an - bn, carry);
+}
+
+limb_t add_1(limb_t* r, limb_t const* a, size_t n, limb_t b)
+{
+    size_t i = 0;
+    for (; i != n && b != 0; ++i)
+    {
+        limb_t t = a[i] + b;
+        b = t < b;
+        r[i] = t;
+    }
+    if (r != a)
+        std::copy(a + i, a + n, r + i);
+    return b;
+}
+
+limb_t sub_n(limb_t* r, limb_t const* a, limb_t const* b, size_t n)
+{
+    limb_t borrow = 0;
+    for (size_t i = 0; i != n; ++i)
+    {
+        limb_t x = a[i];
+        limb_t t = x - b[i];
+        limb_t nb = x < b[i];
+        nb += t < borrow;
+        r[i] = t - borrow;
+        borrow = nb;
+    }
+    return borrow;
+}
+
+limb_t sub(limb_t* r, limb_t const* a, size_t an, limb_t const* b, size_t bn)
+{
+    assert(an >= bn);
+    limb_t borrow = sub_n(r, a, b, bn);
+    return sub_1(r + bn, a + bn, an - bn, borrow);
+}
+
+limb_t sub_1(limb_t* r, limb_t const* a, size_t n, limb_t b)
+{
+    size_t i = 0;
+    for (; i != n && b != 0; ++i)
+    {
+        limb_t x = a[i];
+        r[i] = x - b;
+        b = x < b;
+    }
+    if (r != a)
+        std::copy(a + i, a + n, r + i);
+    return b;
+}
+
+limb_t mul_1(limb_t* r, limb_t const* a, size_t n, limb_t b)
+{
+    limb_t carry = 0;
+    for (size_t i = 0; i != n; ++i)
+    {
+        dlimb_t p = dlimb_t(a[i]) * b + carry;
+        r[i] = static_cast<limb_t>(p);
+        carry = static_cast<limb_t>(p >> limb_bits);
+    }
+    return carry;
+}
+
+limb_t addmul_1(limb_t* r, limb_t const* a, size_t n, limb_t b)
+{
+    // the two additions are carried separately into the high half, which keeps the
+    // 128-bit sum off the critical path: about 1.5 times faster than one wide sum
+    limb_t carry = 0;
+    for (size_t i = 0; i != n; ++i)
+    {
+        dlimb_t p = dlimb_t(a[i]) * b;
+        limb_t lo = static_cast<limb_t>(p);
+        limb_t hi = static_cast<limb_t>(p >> limb_bits);
+        limb_t s = r[i] + lo;
+        hi += s < lo;
+        r[i] = s + carry;
+        hi += r[i] < carry;
+        carry = hi;
+    }
+    return carry;
+}
+
+limb_t submul_1(limb_t* r, limb_t const* a, size_t n, limb_t b)
+{
+    limb_t carry = 0;
+    for (size_t i = 0; i != n; ++i)
+    {
+        dlimb_t p = dlimb_t(a[i]) * b + carry;
+        limb_t lo = static_cast<limb_t>(p);
+        carry = static_cast<limb_t>(p >> limb_bits);
+        limb_t x = r[i];
+        r[i] = x - lo;
+        carry += x < lo;
+    }
+    return carry;
+}
+
+size_t karatsuba_threshold = 24;
+size_t toom3_threshold = 112;
+size_t sqr_karatsuba_threshold = 48;
+size_t sqr_toom3_threshold = 180;
+
+namespace
+{
+void mul_basecase(limb_t* r, limb_t const* a, size_t an, limb_t const* b, size_t bn)
+{
+    r[an] = mul_1(r, a, an, b[0]);
+    for (size_t i = 1; i != bn; ++i)
+        r[an + i] = addmul_1(r + i, a, an, b[i]);
+}
+
+// x = -x modulo B^n
+void negate(limb_t* x, size_t n)
+{
+    for (size_t i = 0; i != n; ++i)
+        x[i] = ~x[i];
+    add_1(x, x, n, 1);
+}
+
+// two's complement x in place to its magnitude, returns whether it was negative
+bool to_magnitude(limb_t* x, size_t n)
+{
+    if ((x[n - 1] >> (limb_bits - 1)) == 0)
+        return false;
+    negate(x, n);
+    return true;
+}
+
+// arithmetic shift right by one of a two's complement value
+void halve_signed(limb_t* x, size_t n)
+{
+    limb_t sign = x[n - 1] & (limb_t(1) << (limb_bits - 1));
+    rshift(x, x, n, 1);
+    x[n - 1] |= sign;
+}
+
+// x /= 3 modulo B^n, exact when 3 divides x
+void divexact_by3(limb_t* x, size_t n)
+{
+    limb_t const inv3 = 0xAAAAAAAAAAAAAAABULL;
+    limb_t borrow = 0;
+    for (size_t i = 0; i != n; ++i)
+    {
+        limb_t s = x[i] - borrow;
+        limb_t under = x[i] < borrow;
+        limb_t q = s * inv3;
+        x[i] = q;
+        borrow = under + static_cast<limb_t>((dlimb_t(q) * 3) >> limb_bits);
+    }
+}
+
+// r[0, an) = |a - b|, an >= bn, returns whether a < b
+bool abs_diff(limb_t* r, limb_t const* a, size_t an, limb_t const* b, size_t bn)
+{
+    if (cmp(a, an, b, bn) >= 0)
+    {
+        sub(r, a, an, b, bn);
+        return false;
+    }
+    sub(r, b, bn, a, bn);
+    std::fill(r + bn, r + an, limb_t(0));
+    return true;
+}
+
+// r += x where x is a nonnegative value stored in xn limbs that is known to fit
+void add_into(limb_t* r, size_t rn, limb_t const* x, size_t xn)
+{
+    xn = normalized_size(x, xn);
+    assert(xn <= rn);
+    limb_t carry = add(r, r, rn, x, xn);
+    assert(carry == 0);
+    (void)carry;
+}
+
+// a = a1 * B^h + a0, b = b1 * B^h + b0,
+// a * b = a0 b0 + (a0 b0 + a1 b1 - (a1 - a0)(b1 - b0)) B^h + a1 b1 B^2h
+void mul_karatsuba(limb_t* r, limb_t const* a, limb_t const* b, size_t n, limb_t* scratch)
+{
+    size_t h = n / 2;
+    size_t m = n - h;
+    limb_t* da = scratch;
+    limb_t* db = da + m;
+    limb_t* t = db + m;
+    limb_t* z = t + 2 * m;
+    limb_t* next = z + 2 * m + 1;
+
+    bool t_negative = abs_diff(da, a + h, m, a, h) != abs_diff(db, b + h, m, b, h);
+    mul_n(r, a, b, h, next);
+    mul_n(r + 2 * h, a + h, b + h, m, next);
+    mul_n(t, da, db, m, next);
+
+    z[2 * m] = add(z, r + 2 * h, 2 * m, r, 2 * h);
+    if (t_negative)
+        z[2 * m] += add_n(z, z, t, 2 * m);
+    else
+        z[2 * m] -= sub_n(z, z, t, 2 * m);
+    add_into(r + h, 2 * n - h, z, 2 * m + 1);
+}
+
+// out[0, w) = x * y in two's complement, x and y are two's complement values of k + 2 limbs
+// whose magnitudes fit in k + 1 limbs; x and y are clobbered
+void mul_signed(limb_t* out, size_t w, limb_t* x, limb_t* y, size_t k, limb_t* scratch)
+{
+    bool negative = to_magnitude(x, k + 2) != to_magnitude(y, k + 2);
+    mul_n(out, x, y, k + 1, scratch);
+    std::fill(out + 2 * k + 2, out + w, limb_t(0));
+    if (negative)
+        negate(out, w);
+}
+
+// Toom-3 with evaluation points 0, 1, -1, -2, inf and Bodrato's interpolation sequence
+void mul_toom3(limb_t* r, limb_t const* a, limb_t const* b, size_t n, limb_t* scratch)
+{
+    size_t k = (n + 2) / 3;
+    size_t s = n - 2 * k;
+    assert(s > 0 && s <= k);
+    // evaluations are signed and take k + 2 limbs, point products take w limbs
+    size_t e = k + 2;
+    size_t w = 2 * k + 3;
+    limb_t* pa = scratch;
+    limb_t* pb = pa + e;
+    limb_t* qa = pb + e;
+    limb_t* qb = qa + e;
+    limb_t* t1 = qb + e;
+    limb_t* tm1 = t1 + w;
+    limb_t* tm2 = tm1 + w;
+    limb_t* next = tm2 + w;
+
+    limb_t const* parts[2] = {a, b};
+    limb_t* pm1[2] = {pa, pb};
+    limb_t* pm2[2] = {qa, qb};
+    for (size_t i = 0; i != 2; ++i)
+    {
+        limb_t const* x = parts[i];
+        limb_t* v = pm1[i];
+        limb_t* u = pm2[i];
+        // p(-1) = x0 - x1 + x2
+        std::copy(x, x + k, v);
+        v[k] = v[k + 1] = 0;
+        add(v, v, e, x + 2 * k, s);
+        sub(v, v, e, x + k, k);
+        // p(-2) = 2 (p(-1) + x2) - x0
+        std::copy(v, v + e, u);
+        add(u, u, e, x + 2 * k, s);
+        lshift(u, u, e, 1);
+        sub(u, u, e, x, k);
+    }
+    mul_signed(tm1, w, pa, pb, k, next);
+    mul_signed(tm2, w, qa, qb, k, next);
+
+    for (size_t i = 0; i != 2; ++i)
+    {
+        limb_t const* x = parts[i];
+        limb_t* v = pm1[i];
+        // p(1) = x0 + x1 + x2
+        std::copy(x, x + k, v);
+        v[k] = v[k + 1] = 0;
+        add(v, v, e, x + k, k);
+        add(v, v, e, x + 2 * k, s);
+    }
+    mul_signed(t1, w, pa, pb, k, next);
+
+    // r(0) and r(inf) go straight to their final place
+    limb_t* r0 = r;
+    limb_t* rinf = r + 4 * k;
+    mul_n(r0, a, b, k, next);
+    mul_n(rinf, a + 2 * k, b + 2 * k, s, next);
+    std::fill(r + 2 * k, r + 4 * k, limb_t(0));
+
+    sub_n(tm2, tm2, t1, w);
+    divexact_by3(tm2, w);
+    sub_n(t1, t1, tm1, w);
+    halve_signed(t1, w);
+    sub(tm1, tm1, w, r0, 2 * k);
+    sub_n(tm2, tm1, tm2, w);
+    halve_signed(tm2, w);
+    add(tm2, tm2, w, rinf, 2 * s);
+    add(tm2, tm2, w, rinf, 2 * s);
+    add_n(tm1, tm1, t1, w);
+    sub(tm1, tm1, w, rinf, 2 * s);
+    sub_n(t1, t1, tm2, w);
+
+    add_into(r + k, 2 * n - k, t1, w);
+    add_into(r + 2 * k, 2 * n - 2 * k, tm1, w);
+    add_into(r + 3 * k, 2 * n - 3 * k, tm2, w);
+}
+
+// Squaring follows the same tiers with half the work in the basecase: every cross product
+// a_i a_j, i < j, is computed once and doubled. Karatsuba and Toom-3 need one evaluation per
+// point instead of two and their point products are squares again.
+void sqr_basecase(limb_t* r, limb_t const* a, size_t n)
+{
+    if (n == 1)
+    {
+        dlimb_t p = dlimb_t(a[0]) * a[0];
+        r[0] = static_cast<limb_t>(p);
+        r[1] = static_cast<limb_t>(p >> limb_bits);
+        return;
+    }
+
+    // r[1, 2n - 1) = sum of a_i a_j B^(i + j) over i < j, one row per i
+    r[0] = 0;
+    r[n] = mul_1(r + 1, a + 1, n - 1, a[0]);
+    for (size_t i = 1; i != n - 1; ++i)
+        r[n + i] = addmul_1(r + 2 * i + 1, a + i + 1, n - i - 1, a[i]);
+    r[2 * n - 1] = 0;
+
+    // double it and add the diagonal a_i^2 B^2i
+    lshift(r, r, 2 * n, 1);
+    limb_t carry = 0;
+    for (size_t i = 0; i != n; ++i)
+    {
+        dlimb_t p = dlimb_t(a[i]) * a[i];
+        dlimb_t s = dlimb_t(r[2 * i]) + static_cast<limb_t>(p) + carry;
+        r[2 * i] = static_cast<limb_t>(s);
+        s = dlimb_t(r[2 * i + 1]) + static_cast<limb_t>(p >> limb_bits) + static_cast<limb_t>(s >> limb_bits);
+        r[2 * i + 1] = static_cast<limb_t>(s);
+        carry = static_cast<limb_t>(s >> limb_bits);
+    }
+    assert(carry == 0);
+}
+
+// a = a1 * B^h + a0, a^2 = a0^2 + (a0^2 + a1^2 - (a1 - a0)^2) B^h + a1^2 B^2h
+void sqr_karatsuba(limb_t* r, limb_t const* a, size_t n, limb_t* scratch)
+{
+    size_t h = n / 2;
+    size_t m = n - h;
+    limb_t* d = scratch;
+    limb_t* t = d + m;
+    limb_t* z = t + 2 * m;
+    limb_t* next = z + 2 * m + 1;
+
+    abs_diff(d, a + h, m, a, h);
+    sqr_n(r, a, h, next);
+    sqr_n(r + 2 * h, a + h, m, next);
+    sqr_n(t, d, m, next);
+
+    z[2 * m] = add(z, r + 2 * h, 2 * m, r, 2 * h);
+    z[2 * m] -= sub_n(z, z, t, 2 * m);
+    add_into(r + h, 2 * n - h, z, 2 * m + 1);
+}
+
+// out[0, w) = x^2, x is a two's complement value of k + 2 limbs whose magnitude fits
+// in k + 1 limbs; x is clobbered
+void sqr_signed(limb_t* out, size_t w, limb_t* x, size_t k, limb_t* scratch)
+{
+    to_magnitude(x, k + 2);
+    sqr_n(out, x, k + 1, scratch);
+    std::fill(out + 2 * k + 2, out + w, limb_t(0));
+}
+
+// mul_toom3 with a == b
+void sqr_toom3(limb_t* r, limb_t const* a, size_t n, limb_t* scratch)
+{
+    size_t k = (n + 2) / 3;
+    size_t s = n - 2 * k;
+    assert(s > 0 && s <= k);
+    size_t e = k + 2;
+    size_t w = 2 * k + 3;
+    limb_t* v = scratch;
+    limb_t* u = v + e;
+    limb_t* t1 = u + e;
+    limb_t* tm1 = t1 + w;
+    limb_t* tm2 = tm1 + w;
+    limb_t* next = tm2 + w;
+
+    // p(-1) = a0 - a1 + a2, p(-2) = 2 (p(-1) + a2) - a0
+    std::copy(a, a + k, v);
+    v[k] = v[k + 1] = 0;
+    add(v, v, e, a + 2 * k, s);
+    sub(v, v, e, a + k, k);
+    std::copy(v, v + e, u);
+    add(u, u, e, a + 2 * k, s);
+    lshift(u, u, e, 1);
+    sub(u, u, e, a, k);
+    sqr_signed(tm1, w, v, k, next);
+    sqr_signed(tm2, w, u, k, next);
+
+    // p(1) = a0 + a1 + a2
+    std::copy(a, a + k, v);
+    v[k] = v[k + 1] = 0;
+    add(v, v, e, a + k, k);
+    add(v, v, e, a + 2 * k, s);
+    sqr_signed(t1, w, v, k, next);
+
+    limb_t* r0 = r;
+    limb_t* rinf = r + 4 * k;
+    sqr_n(r0, a, k, next);
+    sqr_n(rinf, a + 2 * k, s, next);
+    std::fill(r + 2 * k, r + 4 * k, limb_t(0));
+
+    sub_n(tm2, tm2, t1, w);
+    divexact_by3(tm2, w);
+    sub_n(t1, t1, tm1, w);
+    halve_signed(t1, w);
+    sub(tm1, tm1, w, r0, 2 * k);
+    sub_n(tm2, tm1, tm2, w);
+    halve_signed(tm2, w);
+    add(tm2, tm2, w, rinf, 2 * s);
+    add(tm2, tm2, w, rinf, 2 * s);
+    add_n(tm1, tm1, t1, w);
+    sub(tm1, tm1, w, rinf, 2 * s);
+    sub_n(t1, t1, tm2, w);
+
+    add_into(r + k, 2 * n - k, t1, w);
+    add_into(r + 2 * k, 2 * n - 2 * k, tm1, w);
+    add_into(r + 3 * k, 2 * n - 3 * k, tm2, w);
+}
+
+size_t mul_scratch_size(size_t an, size_t bn)
+{
+    if (bn < karatsuba_threshold)
+        return 0;
+    if (an == bn)
+        return mul_n_scratch_size(bn);
+    size_t size = 2 * bn + mul_n_scratch_size(bn);
+    size_t rest = an % bn;
+    if (rest != 0)
+        size = std::max(size, bn + rest + mul_scratch_size(bn, rest));
+    return size;
+}
+
+// unbalanced operands are cut into bn-limb slices of a, each multiplied as a balanced product
+void mul_sliced(limb_t* r, limb_t const* a, size_t an, limb_t const* b, size_t bn, limb_t* scratch)
+{
+    if (bn < karatsuba_threshold)
+    {
+        mul_basecase(r, a, an, b, bn);
+        return;
+    }
+    mul_n(r, a, b, bn, scratch);
+    if (an == bn)
+        return;
+
+    limb_t* t = scratch;
+    size_t offset = bn;
+    for (; offset + bn <= an; offset += bn)
+    {
+        mul_n(t, a + offset, b, bn, t + 2 * bn);
+        limb_t carry = add_n(r + offset, r + offset, t, bn);
+        add_1(r + offset + bn, t + bn, bn, carry);
+    }
+    size_t rest = an - offset;
+    if (rest != 0)
+    {
+        mul_sliced(t, b, bn, a + offset, rest, t + bn + rest);
+        limb_t carry = add_n(r + offset, r + offset, t, bn);
+        add_1(r + offset + bn, t + bn, rest, carry);
+    }
+}
+}
+
+size_t mul_n_scratch_size(size_t n)
+{
+    if (n < karatsuba_threshold)
+        return 0;
+    // the size is not monotonic across thresholds, so every child size is checked
+    if (n < toom3_threshold)
+    {
+        size_t m = n - n / 2;
+        return 6 * m + 1 + std::max(mul_n_scratch_size(m), mul_n_scratch_size(n / 2));
+    }
+    size_t k = (n + 2) / 3;
+    size_t children = std::max(mul_n_scratch_size(k + 1), mul_n_scratch_size(k));
+    children = std::max(children, mul_n_scratch_size(n - 2 * k));
+    return 4 * (k + 2) + 3 * (2 * k + 3) + children;
+}
+
+void mul_n(limb_t* r, limb_t const* a, limb_t const* b, size_t n, limb_t* scratch)
+{
+    if (n < karatsuba_threshold)
+        mul_basecase(r, a, n, b, n);
+    else if (n < toom3_threshold)
+        mul_karatsuba(r, a, b, n, scratch);
+    else
+        mul_toom3(r, a, b, n, scratch);
+}
+
+size_t sqr_n_scratch_size(size_t n)
+{
+    if (n < sqr_karatsuba_threshold)
+        return 0;
+    if (n < sqr_toom3_threshold)
+    {
+        size_t m = n - n / 2;
+        return 5 * m + 1 + std::max(sqr_n_scratch_size(m), sqr_n_scratch_size(n / 2));
+    }
+    size_t k = (n + 2) / 3;
+    size_t children = std::max(sqr_n_scratch_size(k + 1), sqr_n_scratch_size(k));
+    children = std::max(children, sqr_n_scratch_size(n - 2 * k));
+    return 2 * (k + 2) + 3 * (2 * k + 3) + children;
+}
+
+void sqr_n(limb_t* r, limb_t const* a, size_t n, limb_t* scratch)
+{
+    if (n < sqr_karatsuba_threshold)
+        sqr_basecase(r, a, n);
+    else if (n < sqr_toom3_threshold)
+        sqr_karatsuba(r, a, n, scratch);
+    else
+        sqr_toom3(r, a, n, scratch);
+}
+
+void mul(limb_t* r, limb_t const* a, size_t an, limb_t const* b, size_t bn)
+{
+    assert(an >= bn && bn >= 1);
+    if (a == b && an == bn)
+    {
+        sqr(r, a, an);
+        return;
+    }
+    if (bn >= ntt_threshold)
+    {
+        mul_ntt(r, a, an, b, bn);
+        return;
+    }
+    std::vector<limb_t> scratch(mul_scratch_size(an, bn));
+    mul_sliced(r, a, an, b, bn, scratch.data());
+}
+
+void sqr(limb_t* r, limb_t const* a, size_t n)
+{
+    assert(n >= 1);
+    if (n >= ntt_threshold)
+    {
+        sqr_ntt(r, a, n);
+        return;
+    }
+    std::vector<limb_t> scratch(sqr_n_scratch_size(n));
+    sqr_n(r, a, n, scratch.data());
+}
+
+limb_t addmul(limb_t* r, size_t rn, limb_t const* a, size_t an, limb_t const* b, size_t bn)
+{
+    assert(an >= bn && bn >= 1 && rn >= an + bn);
+    if (bn < karatsuba_threshold)
+    {
+        // one row of the schoolbook product at a time, straight into r
+        limb_t carry = 0;
+        for (size_t i = 0; i != bn; ++i)
+        {
+            limb_t c = addmul_1(r + i, a, an, b[i]);
+            carry += add_1(r + i + an, r + i + an, rn - i - an, c);
+        }
+        return carry;
+    }
+    std::vector<limb_t> product(an + bn);
+    mul(product.data(), a, an, b, bn);
+    return add(r, r, rn, product.data(), an + bn);
+}
+
+limb_t submul(limb_t* r, size_t rn, limb_t const* a, size_t an, limb_t const* b, size_t bn)
+{
+    assert(an >= bn && bn >= 1 && rn >= an + bn);
+    if (bn < karatsuba_threshold)
+    {
+        limb_t borrow = 0;
+        for (size_t i = 0; i != bn; ++i)
+        {
+            limb_t c = submul_1(r + i, a, an, b[i]);
+            borrow += sub_1(r + i + an, r + i + an, rn - i - an, c);
+        }
+        return borrow;
+    }
+    std::vector<limb_t> product(an + bn);
+    mul(product.data(), a, an, b, bn);
+    return sub(r, r, rn, product.data(), an + bn);
+}
+
+limb_t lshift(limb_t* r, limb_t const* a, size_t n, unsigned cnt)
+{
+    assert(cnt > 0 && cnt < limb_bits);
+    if (n == 0)
+        return 0;
+    limb_t out = a[n - 1] >> (limb_bits - cnt);
+    for (size_t i = n - 1; i != 0; --i)
+        r[i] = (a[i] << cnt) | (a[i - 1] >> (limb_bits - cnt));
+    r[0] = a[0] << cnt;
+    return out;
+}
+
+limb_t rshift(limb_t* r, limb_t const* a, size_t n, unsigned cnt)
+{
+    assert(cnt > 0 && cnt < limb_bits);
+    if (n == 0)
+        return 0;
+    limb_t out = a[0] << (limb_bits - cnt);
+    for (size_t i = 0; i != n - 1; ++i)
+        r[i] = (a[i] >> cnt) | (a[i + 1] << (limb_bits - cnt));
+    r[n - 1] = a[n - 1] >> cnt;
+    return out;
+}
+
+namespace
+{
+limb_t const hash_prime1 = 0x9E3779B185EBCA87ULL;
+limb_t const hash_prime2 = 0xC2B2AE3D27D4EB4FULL;
+limb_t const hash_prime3 = 0x165667B19E3779F9ULL;
+limb_t const hash_prime4 = 0x85EBCA77C2B2AE63ULL;
+
+limb_t rotl(limb_t x, unsigned r)
+{
+    return (x << r) | (x >> (limb_bits - r));
+}
+
+limb_t hash_round(limb_t acc, limb_t x)
+{
+    return rotl(acc + x * hash_prime2, 31) * hash_prime1;
+}
+}
+
+limb_t hash(limb_t const* a, size_t n, limb_t seed)
+{
+    limb_t h;
+    size_t i = 0;
+    if (n >= 4)
+    {
+        // the lanes carry no dependency on each other, so the loop runs at multiplier throughput
+        limb_t v[4] = {seed + hash_prime1 + hash_prime2, seed + hash_prime2, seed, seed - hash_prime1};
+        for (; i + 4 <= n; i += 4)
+        {
+            for (size_t j = 0; j != 4; ++j)
+                v[j] = hash_round(v[j], a[i + j]);
+        }
+        h = rotl(v[0], 1) + rotl(v[1], 7) + rotl(v[2], 12) + rotl(v[3], 18);
+        for (size_t j = 0; j != 4; ++j)
+            h = (h ^ hash_round(0, v[j])) * hash_prime1 + hash_prime4;
+    }
+    else
+    {
+        h = seed + hash_prime3;
+    }
+    h += n * sizeof(limb_t);
+    for (; i != n; ++i)
+        h = rotl(h ^ hash_round(0, a[i]), 27) * hash_prime1 + hash_prime4;
+
+    h ^= h >> 33;
+    h *= hash_prime2;
+    h ^= h >> 29;
+    h *= hash_prime3;
+    h ^= h >> 32;
+    return h;
+}
+
+unsigned count_leading_zeros(limb_t x)
+{
+    assert(x != 0);
+    return static_cast<unsigned>(__builtin_clzll(x));
+}
+
+unsigned count_trailing_zeros(limb_t x)
+{
+    assert(x != 0);
+    return static_cast<unsigned>(__builtin_ctzll(x));
+}
+}
@@ -0,0 +1,124 @@
+#ifndef LIMBS_H
+#define LIMBS_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Low-level kernels over little-endian arrays of limbs.
+// Unless stated otherwise, the result may alias an operand starting at the same limb.
+namespace limbs
+{
+typedef uint64_t limb_t;
+__extension__ typedef unsigned __int128 dlimb_t;
+
+unsigned const limb_bits = 64;
+limb_t const limb_max = ~limb_t(0);
+
+size_t normalized_size(limb_t const* a, size_t n);
+
+int cmp(limb_t const* a, limb_t const* b, size_t n);
+int cmp(limb_t const* a, size_t an, limb_t const* b, size_t bn);
+
+// r = a + b, an >= bn, returns carry out
+limb_t add_n(limb_t* r, limb_t const* a, limb_t const* b, size_t n);
+limb_t add(limb_t* r, limb_t const* a, size_t an, limb_t const* b, size_t bn);
+limb_t add_1(limb_t* r, limb_t const* a, size_t n, limb_t b);
+
+// r = a - b, an >= bn, returns borrow out
+limb_t sub_n(limb_t* r, limb_t const* a, limb_t const* b, size_t n);
+limb_t sub(limb_t* r, limb_t const* a, size_t an, limb_t const* b, size_t bn);
+limb_t sub_1(limb_t* r, limb_t const* a, size_t n, limb_t b);
+
+// r = a * b, returns high limb
+limb_t mul_1(limb_t* r, limb_t const* a, size_t n, limb_t b);
+// r += a * b, returns high limb
+limb_t addmul_1(limb_t* r, limb_t const* a, size_t n, limb_t b);
+// r -= a * b, returns borrow limb
+limb_t submul_1(limb_t* r, limb_t const* a, size_t n, limb_t b);
+
+// Operand sizes (in limbs) at which multiplication switches to the next algorithm:
+// schoolbook below karatsuba_threshold, Karatsuba below toom3_threshold, Toom-3 below ntt_threshold
+// and the number-theoretic transform above. Tuned with `big_integer_benchmark mul`.
+extern size_t karatsuba_threshold;
+extern size_t toom3_threshold;
+extern size_t ntt_threshold;
+// The same crossovers for squaring, whose basecase does half the limb products.
+// Tuned with `big_integer_benchmark sqr`.
+extern size_t sqr_karatsuba_threshold;
+extern size_t sqr_toom3_threshold;
+
+// r[0, an + bn) = a * b, an >= bn >= 1, r must not overlap operands
+// a == b with an == bn is recognised as a square
+void mul(limb_t* r, limb_t const* a, size_t an, limb_t const* b, size_t bn);
+// r[0, 2n) = a * a, n >= 1, r must not overlap a
+void sqr(limb_t* r, limb_t const* a, size_t n);
+// The balanced products behind mul and sqr below ntt_threshold, on scratch of
+// mul_n_scratch_size(n) and sqr_n_scratch_size(n) limbs from the caller, so that repeated
+// products of one size allocate nothing: r[0, 2n) = a * b and a * a, n >= 1, r must not
+// overlap the operands or the scratch.
+size_t mul_n_scratch_size(size_t n);
+void mul_n(limb_t* r, limb_t const* a, limb_t const* b, size_t n, limb_t* scratch);
+size_t sqr_n_scratch_size(size_t n);
+void sqr_n(limb_t* r, limb_t const* a, size_t n, limb_t* scratch);
+
+// r[0, rn) += a * b and r[0, rn) -= a * b, an >= bn >= 1, rn >= an + bn, r must not overlap
+// operands; returns carry or borrow out. Below karatsuba_threshold the product is accumulated
+// row by row without a temporary.
+limb_t addmul(limb_t* r, size_t rn, limb_t const* a, size_t an, limb_t const* b, size_t bn);
+limb_t submul(limb_t* r, size_t rn, limb_t const* a, size_t an, limb_t const* b, size_t bn);
+
+// the transform-based products behind mul and sqr, any sizes
+void mul_ntt(limb_t* r, limb_t const* a, size_t an, limb_t const* b, size_t bn);
+void sqr_ntt(limb_t* r, limb_t const* a, size_t n);
+
+// Divisor size (in limbs) from which division recurses (Burnikel-Ziegler) instead of running
+// algorithm D, must be at least 2. Tuned with `big_integer_benchmark div`.
+extern size_t bz_threshold;
+// Divisor and quotient size (in limbs) above which big_integer division multiplies by
+// a Newton reciprocal of the divisor instead of calling divrem, at least 1. Building the
+// reciprocal costs several products, so a single division only gains at very large sizes;
+// big_integer_reciprocal amortizes it over many. Tuned with `big_integer_benchmark div`.
+extern size_t newton_threshold;
+// Size (in limbs) of the leading part of a divisor up to which the Newton iteration stops
+// doubling its precision and finds the reciprocal by one division, at least 1. Separate from
+// newton_threshold: a reciprocal of any size recurses down to this many limbs.
+extern size_t newton_basecase_threshold;
+
+// q = a / d, returns a % d, q may alias a
+limb_t divrem_1(limb_t* q, limb_t const* a, size_t n, limb_t d);
+// a % d
+limb_t mod_1(limb_t const* a, size_t n, limb_t d);
+// Montgomery reduction (REDC): r[0, n) = t B^-n mod m for t[0, 2n) < m B^n, m odd,
+// minv = -m^-1 mod B; t is clobbered, r must not overlap t or m
+void redc(limb_t* r, limb_t* t, limb_t const* m, size_t n, limb_t minv);
+// q[0, an - bn + 1) = a / b, r[0, bn) = a % b, an >= bn >= 1, b[bn - 1] != 0
+// q and r must not overlap operands
+void divrem(limb_t* q, limb_t* r, limb_t const* a, size_t an, limb_t const* b, size_t bn);
+
+// Operand size (in limbs) from which gcd reduces the pair by half-gcd, recursing on leading
+// halves, instead of Lehmer steps from the leading two limbs; and the size below which the
+// recursion itself runs Lehmer steps, at least 4. Tuned with `big_integer_benchmark gcd`.
+extern size_t gcd_threshold;
+extern size_t hgcd_threshold;
+
+// binary gcd of two limbs
+limb_t gcd_1(limb_t a, limb_t b);
+// Lehmer's double-digit step: Euclid on x >= y, the leading bits of two numbers. After the
+// returned number k of steps the pair is ((-1)^k (u0 x - v0 y), (-1)^(k+1) (u1 x - v1 y)).
+// Steps are taken while y >= ymin and the cofactors fit in a limb; unless exact, only while
+// the quotients certainly agree with those of the full numbers.
+size_t hgcd2(dlimb_t x, dlimb_t y, dlimb_t ymin, bool exact, limb_t (&u)[2], limb_t (&v)[2]);
+
+// 0 < cnt < limb_bits, return bits shifted out
+// lshift allows r >= a, rshift allows r <= a
+limb_t lshift(limb_t* r, limb_t const* a, size_t n, unsigned cnt);
+limb_t rshift(limb_t* r, limb_t const* a, size_t n, unsigned cnt);
+
+// 64-bit hash of a[0, n), four independent lanes of xxHash64 rounds
+limb_t hash(limb_t const* a, size_t n, limb_t seed);
+
+unsigned count_leading_zeros(limb_t x);
+unsigned count_trailing_zeros(limb_t x);
+}
+
+#endif // LIMBS_H